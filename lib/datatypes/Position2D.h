@@ -36,7 +36,7 @@ using UnitVector2D = cv::Point2d;
 class Position2D : public Position {
 
 public:
-    Position2D(const std::string &label) :
+    Position2D(const std::string &label = "") :
       Position(label)
     {
         // Nothing
@@ -66,6 +66,22 @@ public:
         writer.String("usec");
         writer.Int64(sample_.microseconds().count());
 
+        // Samples dropped before this one
+        writer.String("drop");
+        writer.Uint64(sample_.dropped());
+
+        SerializeFields(writer);
+
+        writer.EndObject();
+    }
+
+    /**
+     * Serialize everything but sample information into the current object,
+     * e.g. for each position of a list that shares one sample.
+     */
+    template <typename Writer>
+    void SerializeFields(Writer& writer) const {
+
         // Coordinate system
         writer.String("unit");
         writer.Int(static_cast<int>(unit_of_length_));
@@ -114,8 +130,6 @@ public:
             writer.String("reg");
             writer.String(region);
         }
-
-        writer.EndObject();
     }
     
     void setCoordSystem(const DistanceUnit value, 
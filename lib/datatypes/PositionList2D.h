@@ -0,0 +1,143 @@
+//******************************************************************************
+//* File:   PositionList2D.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_POSITIONLIST2D_H
+#define	OAT_POSITIONLIST2D_H
+
+#include <cstdint>
+#include <string>
+
+#include "Position.h"
+#include "Position2D.h"
+
+namespace oat {
+
+// Maximum number of positions in a list
+static constexpr size_t POSITION_LIST_CAPACITY {64};
+
+/**
+ * A list of 2D positions sharing one sample, e.g. every object found by a
+ * detector in a single frame. Storage is fixed so that lists can be shared
+ * between components.
+ */
+class PositionList2D : public Position {
+
+public:
+
+    PositionList2D(const std::string &label) :
+      Position(label)
+    {
+        // Nothing
+    }
+
+    PositionList2D(const PositionList2D &l) :
+      Position(l.label_)
+    {
+        *this = l;
+    }
+
+    PositionList2D & operator = (const PositionList2D &l) {
+
+        // Check for self assignment
+        if (this == &l)
+            return *this;
+
+        // Copy all except label_ and unused positions
+        Position::operator=(l);
+        size_ = l.size_;
+        for (size_t i = 0; i < size_; i++) {
+            ids_[i] = l.ids_[i];
+            positions_[i] = l.positions_[i];
+        }
+
+        return *this;
+    }
+
+    size_t size(void) const { return size_; }
+    bool empty(void) const { return size_ == 0; }
+    bool full(void) const { return size_ == POSITION_LIST_CAPACITY; }
+    void clear(void) { size_ = 0; }
+
+    /**
+     * Append a position.
+     * @param position Position to append
+     * @param id Identifier of the position within the list
+     * @return False if the list is full, in which case nothing is appended.
+     */
+    bool push_back(const Position2D &position, const uint32_t id) {
+
+        if (full())
+            return false;
+
+        ids_[size_] = id;
+        positions_[size_++] = position;
+        return true;
+    }
+
+    Position2D & operator[](const size_t i) { return positions_[i]; }
+    const Position2D & operator[](const size_t i) const { return positions_[i]; }
+    uint32_t id(const size_t i) const { return ids_[i]; }
+
+    Position2D * begin(void) { return positions_; }
+    Position2D * end(void) { return positions_ + size_; }
+    const Position2D * begin(void) const { return positions_; }
+    const Position2D * end(void) const { return positions_ + size_; }
+
+    template <typename Writer>
+    void Serialize(Writer& writer) const {
+
+        writer.StartObject();
+
+        // Sample number
+        writer.String("samp");
+        writer.Int(sample_.count());
+
+        writer.String("usec");
+        writer.Int64(sample_.microseconds().count());
+
+        // Samples dropped before this one
+        writer.String("drop");
+        writer.Uint64(sample_.dropped());
+
+        // Positions
+        writer.String("pos_list");
+        writer.StartArray();
+
+        for (size_t i = 0; i < size_; i++) {
+            writer.StartObject();
+            writer.String("id");
+            writer.Uint(ids_[i]);
+            positions_[i].SerializeFields(writer);
+            writer.EndObject();
+        }
+
+        writer.EndArray(size_);
+
+        writer.EndObject();
+    }
+
+private:
+
+    size_t size_ {0};
+    uint32_t ids_[POSITION_LIST_CAPACITY];
+    Position2D positions_[POSITION_LIST_CAPACITY];
+};
+
+}      /* namespace oat */
+#endif /* OAT_POSITIONLIST2D_H */
@@ -67,6 +67,20 @@ public:
         return ++count_; 
     }
 
+    // Take the count a sample was given elsewhere, e.g. when replaying a
+    // recording
+    uint64_t set_count(const uint64_t count, const Microseconds usec) {
+        microseconds_ = usec;
+        count_ = count;
+        return count_;
+    }
+
+    // Record samples that were acquired but never published by the SINK
+    uint64_t incrementDropped(const uint64_t n) {
+        dropped_ += n;
+        return dropped_;
+    }
+
     void set_rate_hz(const double value) { 
         rate_hz_ = value;
         period_sec_ = 1.0 / value;
@@ -78,6 +92,7 @@ public:
     }
 
     uint64_t count() const { return count_; }
+    uint64_t dropped() const { return dropped_; }
     Microseconds microseconds() const { return microseconds_; }
     double period_sec() const { return period_sec_; }
     double rate_hz() const { return 1.0 / period_sec_; }
@@ -85,6 +100,7 @@ public:
 private:
 
     uint64_t count_ {0};
+    uint64_t dropped_ {0};
     Microseconds microseconds_ {0};
     double period_sec_ {-1.0};
     double rate_hz_ {-1.0};
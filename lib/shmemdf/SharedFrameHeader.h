@@ -52,6 +52,11 @@ public :
     int type() const { return type_; }
     handle_t sample() const { return sample_; }
     handle_t data() const { return data_; }
+    double offset_x() const { return offset_x_; }
+    double offset_y() const { return offset_y_; }
+    double scale_x() const { return scale_x_; }
+    double scale_y() const { return scale_y_; }
+    bool packed() const { return packed_; }
 
     /**
      * Set header data fields.
@@ -74,6 +79,36 @@ public :
         type_ = type;
     }
 
+    /**
+     * Set the mapping of the frame's pixel coordinates to those of the full
+     * sensor frame, for frames that have been cropped or resized. Pixel
+     * (x, y) lies at (offset_x + scale_x * x, offset_y + scale_y * y) in the
+     * full sensor frame.
+     *
+     * @param x Horizontal position of the frame's upper left pixel
+     * @param y Vertical position of the frame's upper left pixel
+     * @param scale_x Width of the frame's pixels in full frame pixels
+     * @param scale_y Height of the frame's pixels in full frame pixels
+     */
+    void setOffset(const double x, const double y,
+                   const double scale_x = 1.0, const double scale_y = 1.0) {
+        offset_x_ = x;
+        offset_y_ = y;
+        scale_x_ = scale_x;
+        scale_y_ = scale_y;
+    }
+
+    /**
+     * Mark the frame as a packed binary mask (see PackedMask.h). The
+     * matrix data then holds rows x packedCols(cols) bytes and type is
+     * CV_8UC1.
+     *
+     * @param packed True if the frame is packed
+     */
+    void setPacked(const bool packed) {
+        packed_ = packed;
+    }
+
 private :
 
     // TODO: Should these be atomic? They should already be protected by
@@ -85,6 +120,11 @@ private :
     std::atomic<int> rows_ {0};
     std::atomic<int> cols_ {0};
     std::atomic<int> type_ {0};
+    std::atomic<double> offset_x_ {0.0};
+    std::atomic<double> offset_y_ {0.0};
+    std::atomic<double> scale_x_ {1.0};
+    std::atomic<double> scale_y_ {1.0};
+    std::atomic<bool> packed_ {false};
 
     // Interprocess matrix data and sample handles
     std::atomic<handle_t> data_;
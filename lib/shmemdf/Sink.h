@@ -28,6 +28,7 @@
 
 #include "../datatypes/Sample.h"
 #include "../datatypes/Frame.h"
+#include "../utility/PackedMask.h"
 
 #include "ForwardsDecl.h"
 #include "Node.h"
@@ -222,7 +223,10 @@ class Sink<SharedFrameHeader> : public SinkBase<SharedFrameHeader> {
 
 public:
     void bind(const std::string &address, const size_t bytes);
-    oat::Frame retrieve(const size_t rows, size_t cols, const int type);
+    oat::Frame retrieve(const size_t rows, size_t cols, const int type,
+                        const double offset_x = 0.0, const double offset_y = 0.0,
+                        const bool packed = false,
+                        const double scale_x = 1.0, const double scale_y = 1.0);
 };
 
 inline void Sink<SharedFrameHeader>::bind(const std::string &address, const size_t bytes) {
@@ -267,7 +271,14 @@ inline void Sink<SharedFrameHeader>::bind(const std::string &address, const size
     }
 }
 
-inline oat::Frame Sink<SharedFrameHeader>::retrieve(const size_t rows, const size_t cols, const int type) {
+inline oat::Frame Sink<SharedFrameHeader>::retrieve(const size_t rows,
+                                                    const size_t cols,
+                                                    const int type,
+                                                    const double offset_x,
+                                                    const double offset_y,
+                                                    const bool packed,
+                                                    const double scale_x,
+                                                    const double scale_y) {
 
     // Make sure that the SINK is bound to a shared memory segment
     //assert(bound_);
@@ -278,16 +289,24 @@ inline oat::Frame Sink<SharedFrameHeader>::retrieve(const size_t rows, const siz
     void * sample = obj_shmem_.allocate(sizeof(oat::Sample));
     handle_t sample_handle = obj_shmem_.get_handle_from_address(sample);
 
+    // Packed masks are stored as one bit per pixel
+    if (packed && type != CV_8UC1)
+        throw (std::runtime_error("Packed frames must have type CV_8UC1."));
+
+    const int data_cols = packed ? oat::packedCols(cols) : cols;
+
     // Allocate memory for the shared object's data
-    cv::Mat temp(rows, cols, type);
-    void * data = obj_shmem_.allocate(temp.total() * temp.elemSize());
+    void * data = obj_shmem_.allocate(rows * data_cols * CV_ELEM_SIZE(type));
     handle_t data_handle = obj_shmem_.get_handle_from_address(data);
 
     // Reset the SharedFrameHeader's parameters now that we know what they should be
+    sh_object_->setOffset(offset_x, offset_y, scale_x, scale_y);
+    sh_object_->setPacked(packed);
     sh_object_->setParameters(data_handle, sample_handle, rows, cols, type);
 
-    // Return pointer to memory allocated for shared object
-    return oat::Frame(rows, cols, type, data, sample);
+    // Return pointer to memory allocated for shared object. For packed
+    // frames, this holds the packed bytes.
+    return oat::Frame(rows, data_cols, type, data, sample);
 }
 
 } // namespace oat
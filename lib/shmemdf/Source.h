@@ -29,6 +29,7 @@
 #include <boost/thread/thread_time.hpp>
 
 #include "../datatypes/Frame.h"
+#include "../utility/PackedMask.h"
 
 #include "ForwardsDecl.h"
 #include "Node.h"
@@ -288,13 +289,34 @@ public:
         size_t rows  {0};
         size_t type  {0};
         size_t bytes {0};
+
+        // Mapping of frame pixels to the full sensor frame (see
+        // SharedFrameHeader::setOffset())
+        double offset_x {0.0};
+        double offset_y {0.0};
+        double scale_x {1.0};
+        double scale_y {1.0};
+
+        // The node holds a packed binary mask. rows, cols, type and bytes
+        // describe the unpacked frame.
+        bool packed {false};
     };
 
     void connect() override;
 
+    /**
+     * Get the shared frame without a copy. For packed nodes, this holds
+     * the packed bytes.
+     */
     oat::Frame retrieve() const { return frame_; }
-    oat::Frame clone() const { return frame_.clone(); }
-    void copyTo(oat::Frame &frame) const { frame_.copyTo(frame); };
+
+    /**
+     * Copy the shared frame. Packed masks are unpacked, so consumers need
+     * not distinguish packed nodes.
+     */
+    oat::Frame clone() const;
+    void copyTo(oat::Frame &frame) const;
+
     ConnectionParameters parameters() const { return parameters_; }
 
 private :
@@ -336,20 +358,48 @@ inline void Source<SharedFrameHeader>::connect() {
     }
 
     // Generate frame header using info in shmem segment
+    const bool packed = sh_object_->packed();
+    const int cols = sh_object_->cols();
     frame_ = oat::Frame(sh_object_->rows(),
-                        sh_object_->cols(),
+                        packed ? oat::packedCols(cols) : cols,
                         sh_object_->type(),
                         obj_shmem_.get_address_from_handle(sh_object_->data()),
                         obj_shmem_.get_address_from_handle(sh_object_->sample()));
 
     // Save parameters so that to construct cv::Mats with
-    parameters_.cols = sh_object_->cols();
+    parameters_.cols = cols;
     parameters_.rows = sh_object_->rows();
     parameters_.type = sh_object_->type();
-    parameters_.bytes = frame_.total() * frame_.elemSize();
+    parameters_.bytes = parameters_.rows * cols * CV_ELEM_SIZE(parameters_.type);
+    parameters_.offset_x = sh_object_->offset_x();
+    parameters_.offset_y = sh_object_->offset_y();
+    parameters_.scale_x = sh_object_->scale_x();
+    parameters_.scale_y = sh_object_->scale_y();
+    parameters_.packed = packed;
 
     state_ = SourceState::CONNECTED;
 }
 
+inline oat::Frame Source<SharedFrameHeader>::clone() const {
+
+    if (!parameters_.packed)
+        return frame_.clone();
+
+    oat::Frame frame;
+    copyTo(frame);
+    return frame;
+}
+
+inline void Source<SharedFrameHeader>::copyTo(oat::Frame &frame) const {
+
+    if (!parameters_.packed) {
+        frame_.copyTo(frame);
+        return;
+    }
+
+    oat::unpackMask(frame_, parameters_.cols, frame);
+    frame.sample() = frame_.sample();
+}
+
 }      /* namespace oat */
 #endif /* OAT_SOURCE_H */
@@ -0,0 +1,130 @@
+//******************************************************************************
+//* File:   BandPool.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+
+#include "BandPool.h"
+
+namespace oat {
+
+namespace {
+
+// Index of this thread within its pool. Threads that are not pool threads,
+// including those that call run(), are 0.
+thread_local size_t worker_index {0};
+
+} /* namespace */
+
+BandPool::BandPool(const size_t num_threads)
+{
+    for (size_t i = 1; i < num_threads; i++)
+        workers_.emplace_back(&BandPool::work, this, i);
+}
+
+BandPool::~BandPool() {
+
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        running_ = false;
+    }
+
+    start_cv_.notify_all();
+
+    for (auto &t : workers_)
+        t.join();
+}
+
+void BandPool::run(const size_t num_bands,
+                   const std::function<void(size_t)> &band) {
+
+    std::unique_lock<std::mutex> lk(mutex_);
+
+    band_ = &band;
+    num_bands_ = num_bands;
+    next_band_ = 0;
+    bands_done_ = 0;
+    generation_++;
+
+    start_cv_.notify_all();
+
+    // The calling thread takes bands too
+    processBands(lk);
+
+    done_cv_.wait(lk, [this] { return bands_done_ == num_bands_; });
+    band_ = nullptr;
+
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+size_t BandPool::workerIndex() {
+
+    return worker_index;
+}
+
+void BandPool::work(const size_t index) {
+
+    worker_index = index;
+
+    uint64_t generation = 0;
+    std::unique_lock<std::mutex> lk(mutex_);
+
+    while (true) {
+
+        start_cv_.wait(lk, [this, generation] {
+            return !running_ || generation_ != generation;
+        });
+
+        if (!running_)
+            return;
+
+        generation = generation_;
+        processBands(lk);
+    }
+}
+
+void BandPool::processBands(std::unique_lock<std::mutex> &lk) {
+
+    while (band_ != nullptr && next_band_ < num_bands_) {
+
+        const size_t i = next_band_++;
+        const auto &band = *band_;
+
+        lk.unlock();
+
+        std::exception_ptr error;
+        try {
+            band(i);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        lk.lock();
+
+        if (error && !error_)
+            error_ = error;
+
+        if (++bands_done_ == num_bands_)
+            done_cv_.notify_all();
+    }
+}
+
+} /* namespace oat */
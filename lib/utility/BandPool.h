@@ -0,0 +1,92 @@
+//******************************************************************************
+//* File:   BandPool.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+
+#ifndef OAT_BANDPOOL_H
+#define	OAT_BANDPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace oat {
+
+/**
+ * Persistent pool of threads that process the bands of a frame in parallel.
+ */
+class BandPool {
+public:
+
+    /**
+     * @param num_threads Total number of threads, including the calling
+     * thread, that process bands.
+     */
+    explicit BandPool(const size_t num_threads);
+
+    ~BandPool();
+
+    // Pools are not copyable
+    BandPool(const BandPool &) = delete;
+    BandPool & operator=(const BandPool &) = delete;
+
+    size_t size() const { return workers_.size() + 1; }
+
+    /**
+     * Call band(i) for i in [0, num_bands) across the pool and the calling
+     * thread. Blocks until all bands are complete. If any band throws, the
+     * first exception is rethrown once the others have finished.
+     * @param num_bands Number of bands.
+     * @param band Function processing a single band.
+     */
+    void run(const size_t num_bands, const std::function<void(size_t)> &band);
+
+    /**
+     * Index of the calling thread within the pool that is running it: 0 for
+     * the thread that called run(), and 1 to size() - 1 for the pool's own
+     * threads. Used by band functions to select per-thread scratch space.
+     */
+    static size_t workerIndex(void);
+
+private:
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+
+    // Current job, guarded by mutex_
+    const std::function<void(size_t)> *band_ {nullptr};
+    size_t num_bands_ {0};
+    size_t next_band_ {0};
+    size_t bands_done_ {0};
+    uint64_t generation_ {0};
+    bool running_ {true};
+    std::exception_ptr error_;
+
+    void work(const size_t index);
+    void processBands(std::unique_lock<std::mutex> &lk);
+};
+
+}      /* namespace oat */
+#endif /* OAT_BANDPOOL_H */
@@ -0,0 +1,146 @@
+//******************************************************************************
+//* File:   PackedMask.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//*******************************************************************************
+
+#ifndef OAT_PACKEDMASK_H
+#define	OAT_PACKEDMASK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <opencv2/core/mat.hpp>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace oat {
+
+/**
+ * Packed binary masks store one bit per pixel. Bit i % 8 of byte i / 8 of
+ * each row holds pixel i, and is set if that pixel is non-zero. Each row
+ * starts on a byte boundary, so a packed rows x cols mask occupies
+ * rows x packedCols(cols) bytes, 8x less than an 8-bit mask and 24x less than
+ * a BGR frame.
+ */
+
+/**
+ * Bytes in a packed row.
+ *
+ * @param cols Pixels in the row.
+ * @return Bytes in the packed row.
+ */
+inline int packedCols(const int cols) { return (cols + 7) / 8; }
+
+/**
+ * Pack a row of 8-bit pixels into bits.
+ *
+ * @param src Row of cols pixels.
+ * @param dst Row of packedCols(cols) bytes.
+ * @param cols Pixels in the row.
+ */
+inline void packRow(const uint8_t *src, uint8_t *dst, const int cols) {
+
+    int i = 0;
+
+#ifdef __SSE2__
+    // The sign bits of a byte-wise comparison against zero give 16 pixels
+    // in one instruction
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= cols; i += 16) {
+
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const int bits = ~_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero));
+        dst[i / 8] = static_cast<uint8_t>(bits);
+        dst[i / 8 + 1] = static_cast<uint8_t>(bits >> 8);
+    }
+#endif
+
+    for (; i < cols; i += 8) {
+
+        uint8_t byte = 0;
+        for (int b = 0; b < 8 && i + b < cols; b++)
+            byte |= static_cast<uint8_t>(src[i + b] != 0) << b;
+
+        dst[i / 8] = byte;
+    }
+}
+
+/**
+ * Unpack a row of bits into 8-bit pixels, which are 0 or 255.
+ *
+ * @param src Row of packedCols(cols) bytes.
+ * @param dst Row of cols pixels.
+ * @param cols Pixels in the row.
+ */
+inline void unpackRow(const uint8_t *src, uint8_t *dst, const int cols) {
+
+    int i = 0;
+
+#ifdef __SSE2__
+    // Broadcast each packed byte to eight lanes and test one bit per lane
+    const __m128i select = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128,
+                                         1, 2, 4, 8, 16, 32, 64, -128);
+    for (; i + 16 <= cols; i += 16) {
+
+        __m128i v = _mm_cvtsi32_si128(src[i / 8] | src[i / 8 + 1] << 8);
+        v = _mm_unpacklo_epi8(v, v);
+        v = _mm_unpacklo_epi16(v, v);
+        v = _mm_unpacklo_epi32(v, v);
+        v = _mm_cmpeq_epi8(_mm_and_si128(v, select), select);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), v);
+    }
+#endif
+
+    for (; i < cols; i++)
+        dst[i] = (src[i / 8] >> (i % 8) & 1) ? 255 : 0;
+}
+
+/**
+ * Pack an 8-bit, single channel mask.
+ *
+ * @param mask Mask to pack. Non-zero pixels are set.
+ * @param packed Packed mask of mask.rows x packedCols(mask.cols) bytes. Not
+ * reallocated if it already has this size, so it may wrap shared memory.
+ */
+inline void packMask(const cv::Mat &mask, cv::Mat &packed) {
+
+    CV_Assert(mask.type() == CV_8UC1);
+    packed.create(mask.rows, packedCols(mask.cols), CV_8UC1);
+
+    for (int r = 0; r < mask.rows; r++)
+        packRow(mask.ptr<uint8_t>(r), packed.ptr<uint8_t>(r), mask.cols);
+}
+
+/**
+ * Unpack a mask into an 8-bit, single channel mask of 0's and 255's.
+ *
+ * @param packed Packed mask.
+ * @param cols Pixels in each row of the mask.
+ * @param mask Unpacked mask of packed.rows x cols pixels.
+ */
+inline void unpackMask(const cv::Mat &packed, const int cols, cv::Mat &mask) {
+
+    CV_Assert(packed.type() == CV_8UC1 && packed.cols == packedCols(cols));
+    mask.create(packed.rows, cols, CV_8UC1);
+
+    for (int r = 0; r < packed.rows; r++)
+        unpackRow(packed.ptr<uint8_t>(r), mask.ptr<uint8_t>(r), cols);
+}
+
+}      /* namespace oat */
+#endif /* OAT_PACKEDMASK_H */
@@ -0,0 +1,97 @@
+//******************************************************************************
+//* File:   RawFrameFormat.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//*******************************************************************************
+
+#ifndef OAT_RAWFRAMEFORMAT_H
+#define	OAT_RAWFRAMEFORMAT_H
+
+#include <cstdint>
+#include <cstring>
+
+namespace oat {
+namespace raw {
+
+/**
+ * Raw frame container. A file consists of a single FileHeader followed by
+ * fixed-size frame records. Each record is a FrameRecord followed by
+ * frame_bytes of continuous pixel data, padded to record_bytes. All sizes
+ * are multiples of ALIGNMENT so that pixel data can be copied directly
+ * from a memory mapping of the file. Values are stored in host byte order.
+ */
+
+static constexpr char MAGIC[8] {'O', 'A', 'T', 'R', 'A', 'W', '\0', '\0'};
+static constexpr uint32_t VERSION {1};
+static constexpr uint64_t ALIGNMENT {64};
+
+struct FileHeader {
+
+    char magic[8];
+    uint32_t version {VERSION};
+    uint32_t header_bytes {sizeof(FileHeader)};
+
+    // Frame geometry and OpenCV matrix type
+    int32_t rows {0};
+    int32_t cols {0};
+    int32_t type {0};
+    uint32_t reserved {0};
+
+    // Bytes of pixel data in each frame and total bytes in each record
+    uint64_t frame_bytes {0};
+    uint64_t record_bytes {0};
+
+    // Sample period of the recorded stream
+    double period_sec {0.0};
+
+    uint8_t padding[8] {};
+
+    FileHeader() { std::memcpy(magic, MAGIC, sizeof(magic)); }
+};
+
+struct FrameRecord {
+
+    // Sample information of the recorded frame
+    uint64_t count {0};
+    int64_t microseconds {0};
+
+    // Samples dropped before the recorded frame. Zero in files written
+    // before it was recorded.
+    uint64_t dropped {0};
+
+    uint8_t padding[ALIGNMENT - 24] {};
+};
+
+static_assert(sizeof(FileHeader) % ALIGNMENT == 0,
+              "FileHeader size must be a multiple of ALIGNMENT");
+static_assert(sizeof(FrameRecord) % ALIGNMENT == 0,
+              "FrameRecord size must be a multiple of ALIGNMENT");
+
+/**
+ * Size of a frame record, including padding.
+ *
+ * @param frame_bytes Bytes of pixel data in each frame.
+ * @return Record size in bytes.
+ */
+inline uint64_t recordBytes(const uint64_t frame_bytes) {
+
+    uint64_t bytes = sizeof(FrameRecord) + frame_bytes;
+    return (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+}      /* namespace raw */
+}      /* namespace oat */
+#endif /* OAT_RAWFRAMEFORMAT_H */
@@ -43,7 +43,9 @@ void FrameBuffer::connectToNode() {
 
     // Bind sink node
     sink_.bind(sink_address_, param.bytes);
-    shared_frame_ = sink_.retrieve(param.rows, param.cols, param.type);
+    shared_frame_ = sink_.retrieve(param.rows, param.cols, param.type,
+                                   param.offset_x, param.offset_y, false,
+                                   param.scale_x, param.scale_y);
 
     // Start consumer thread
     sink_thread_ = std::thread(&FrameBuffer::pop, this);
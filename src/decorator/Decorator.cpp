@@ -85,7 +85,14 @@ void Decorator::connectToNodes() {
 
     // Bind to sink sink node and create a shared cv::Mat
     frame_sink_.bind(frame_sink_address_, param.bytes);
-    shared_frame_ = frame_sink_.retrieve(param.rows, param.cols, param.type);
+    shared_frame_ = frame_sink_.retrieve(param.rows, param.cols, param.type,
+                                         param.offset_x, param.offset_y, false,
+                                         param.scale_x, param.scale_y);
+
+    // Positions are in full sensor frame coordinates, which may differ from
+    // those of cropped or resized frames
+    frame_offset_ = oat::Point2D(param.offset_x, param.offset_y);
+    frame_scale_ = oat::Point2D(param.scale_x, param.scale_y);
 
     // Set drawing parameters based on frame dimensions
     size_t min_size = (param.rows < param.cols) ? param.rows : param.cols;
@@ -210,6 +217,24 @@ void Decorator::invertHomography(oat::Position2D &p) {
     }
 }
 
+void Decorator::toFramePixels(oat::Position2D &p) {
+
+    p.position.x = (p.position.x - frame_offset_.x) / frame_scale_.x;
+    p.position.y = (p.position.y - frame_offset_.y) / frame_scale_.y;
+
+    // Offsets do not apply to velocity or heading
+    p.velocity.x /= frame_scale_.x;
+    p.velocity.y /= frame_scale_.y;
+
+    if (p.heading_valid) {
+        p.heading.x /= frame_scale_.x;
+        p.heading.y /= frame_scale_.y;
+        const double norm = cv::norm(p.heading);
+        if (norm > 0)
+            p.heading /= norm;
+    }
+}
+
 void Decorator::drawPosition() {
 
     size_t i = 0;
@@ -220,6 +245,8 @@ void Decorator::drawPosition() {
         if (p.unit_of_length() != oat::DistanceUnit::PIXELS)
             invertHomography(p);
 
+        toFramePixels(p);
+
         if (p.position_valid) {
 
             cv::circle(internal_frame_,
@@ -98,6 +98,10 @@ private:
     // Positions to be added to the image stream
     std::vector<PositionSource> position_sources_;
 
+    // Mapping of frame pixels to the full sensor frame
+    oat::Point2D frame_offset_ {0.0, 0.0};
+    oat::Point2D frame_scale_ {1.0, 1.0};
+
     // Drawing constants
     // TODO: These may need to become a bit more sophisticated or user defined
     bool decorate_position_ {true};
@@ -130,6 +134,13 @@ private:
      */
     void invertHomography(oat::Position2D &pos);
 
+    /**
+     * Map a Position from full sensor frame pixels to the pixels of the
+     * decorated frame, which may be cropped or resized.
+     * @param pos Position in oat::PIXEL units.
+     */
+    void toFramePixels(oat::Position2D &pos);
+
     // TODO: Look at these glorious type signatures
     void drawPosition(void);
     //void drawHeading(void);
@@ -19,6 +19,8 @@
 
 #include "OatConfig.h" // Generated by CMake
 
+#include <cmath>
+#include <cstdint>
 #include <string>
 #include <iostream>
 #include <opencv2/core.hpp>
@@ -32,6 +34,67 @@
 
 namespace oat {
 
+namespace {
+
+// Subtract a running average background, optionally updating it. The
+// background is stored as value * 256. Loops are written so that the
+// compiler can vectorize them.
+template <bool Update>
+void subtractAverage(cv::Mat &frame, cv::Mat &background_q8,
+                     const cv::Range &rows, const int alpha_q8) {
+
+    const int cols = frame.cols * frame.channels();
+
+    for (int r = rows.start; r < rows.end; r++) {
+
+        uint8_t * __restrict f = frame.ptr<uint8_t>(r);
+        uint16_t * __restrict b = background_q8.ptr<uint16_t>(r);
+
+        for (int i = 0; i < cols; i++) {
+
+            const int32_t fi = f[i];
+            int32_t bi = b[i];
+
+            if (Update) {
+                bi += ((fi << 8) - bi) * alpha_q8 >> 8;
+                b[i] = static_cast<uint16_t>(bi);
+            }
+
+            const int32_t d = fi - ((bi + 128) >> 8);
+            f[i] = static_cast<uint8_t>(d < 0 ? 0 : d);
+        }
+    }
+}
+
+// Subtract a running median background, optionally updating it by stepping
+// each pixel one intensity level towards the current frame.
+template <bool Update>
+void subtractMedian(cv::Mat &frame, cv::Mat &background, const cv::Range &rows) {
+
+    const int cols = frame.cols * frame.channels();
+
+    for (int r = rows.start; r < rows.end; r++) {
+
+        uint8_t * __restrict f = frame.ptr<uint8_t>(r);
+        uint8_t * __restrict b = background.ptr<uint8_t>(r);
+
+        for (int i = 0; i < cols; i++) {
+
+            const uint8_t fi = f[i];
+            uint8_t bi = b[i];
+
+            if (Update) {
+                bi = bi + (fi > bi) - (fi < bi);
+                b[i] = bi;
+            }
+
+            f[i] = fi > bi ? fi - bi : 0;
+        }
+    }
+}
+
+} /* namespace */
+
 BackgroundSubtractor::BackgroundSubtractor(
             const std::string &frame_source_address,
             const std::string &frame_sink_address) :
@@ -43,7 +106,10 @@ BackgroundSubtractor::BackgroundSubtractor(
 void BackgroundSubtractor::configure(const std::string& config_file, const std::string& config_key) {
 
     // Available options
-    std::vector<std::string> options {"background"};
+    std::vector<std::string> options {"background",
+                                      "adaptation",
+                                      "learning_coeff",
+                                      "update_interval"};
 
     // This will throw cpptoml::parse_exception if a file
     // with invalid TOML is provided
@@ -69,6 +135,34 @@ void BackgroundSubtractor::configure(const std::string& config_file, const std::
             background_set = true;
         }
 
+        // Background model
+        std::string adaptation;
+        if (oat::config::getValue(this_config, "adaptation", adaptation)) {
+
+            if (adaptation == "static")
+                mode_ = Mode::STATIC;
+            else if (adaptation == "average")
+                mode_ = Mode::AVERAGE;
+            else if (adaptation == "median")
+                mode_ = Mode::MEDIAN;
+            else
+                throw (std::runtime_error("Adaptation must be 'static', "
+                                          "'average', or 'median'."));
+        }
+
+        // Weight given to each new frame by the running average
+        if (oat::config::getValue(this_config, "learning_coeff",
+                                  learning_coeff_, 0.0, 1.0)) {
+
+            learning_coeff_q8_ = static_cast<int>(std::lround(learning_coeff_ * 256));
+            if (learning_coeff_ > 0.0 && learning_coeff_q8_ == 0)
+                learning_coeff_q8_ = 1;
+        }
+
+        // Number of frames between background updates
+        oat::config::getValue(this_config, "update_interval",
+                              update_interval_, (int64_t)1);
+
     } else {
         throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
     }
@@ -78,19 +172,69 @@ void BackgroundSubtractor::setBackgroundImage(const cv::Mat& frame) {
 
     background_frame = frame.clone();
     background_set = true;
+
+    if (mode_ == Mode::AVERAGE)
+        background_frame.convertTo(background_q8_, CV_16U, 256);
 }
 
-void BackgroundSubtractor::filter(cv::Mat& frame) {
+bool BackgroundSubtractor::beginFrame(cv::Mat& frame) {
     // Throws cv::Exception if there is a size mismatch between frames,
     // or in any case where cv assertions fail.
 
-    // Only proceed with processing if we are getting a valid frame
-    if (background_set)
-        frame = frame - background_frame;
-    else
-        // First image is always used as the default background image if one is
-        // not provided in a configuration file
+    // First image is always used as the default background image if one is
+    // not provided in a configuration file
+    if (!background_set) {
         setBackgroundImage(frame);
+        return false;
+    }
+
+    CV_Assert(frame.size() == background_frame.size()
+              && frame.type() == background_frame.type());
+
+    if (mode_ == Mode::STATIC)
+        return true;
+
+    CV_Assert(frame.depth() == CV_8U);
+
+    // A configured background image is converted on the first frame
+    if (mode_ == Mode::AVERAGE && background_q8_.empty())
+        background_frame.convertTo(background_q8_, CV_16U, 256);
+
+    update_ = ++frames_since_update_ >= update_interval_;
+    if (update_)
+        frames_since_update_ = 0;
+
+    return true;
+}
+
+void BackgroundSubtractor::filterBand(cv::Mat& frame,
+                                      const cv::Range &rows,
+                                      const cv::Range &) {
+
+    switch (mode_) {
+        case Mode::STATIC :
+        {
+            cv::Mat band = frame.rowRange(rows);
+            cv::subtract(band, background_frame.rowRange(rows), band);
+            break;
+        }
+        case Mode::AVERAGE :
+        {
+            if (update_)
+                subtractAverage<true>(frame, background_q8_, rows, learning_coeff_q8_);
+            else
+                subtractAverage<false>(frame, background_q8_, rows, learning_coeff_q8_);
+            break;
+        }
+        case Mode::MEDIAN :
+        {
+            if (update_)
+                subtractMedian<true>(frame, background_frame, rows);
+            else
+                subtractMedian<false>(frame, background_frame, rows);
+            break;
+        }
+    }
 }
 
 } /* namespace oat */
\ No newline at end of file
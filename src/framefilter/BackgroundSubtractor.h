@@ -20,12 +20,16 @@
 #ifndef OAT_BACKGROUNDSUBTRACTOR_H
 #define	OAT_BACKGROUNDSUBTRACTOR_H
 
+#include <opencv2/core/mat.hpp>
+
 #include "FrameFilter.h"
 
 namespace oat {
 
 /**
- * A basic background subtractor.
+ * A basic background subtractor. The background is either static or adapts
+ * to slow changes, such as lighting drift, using a running average or
+ * running median of the SOURCE frames.
  */
 class BackgroundSubtractor : public FrameFilter {
 public:
@@ -46,12 +50,34 @@ public:
 
 private:
 
+    // Background model
+    enum class Mode
+    {
+        STATIC,   //!< Fixed background frame
+        AVERAGE,  //!< Exponential running average
+        MEDIAN    //!< Approximate running median
+    };
+
+    // Pixels are independent, so frames can be processed in bands
+    bool bandable(void) const override { return true; }
+
+    /**
+     * Set the background from the first frame and decide whether the
+     * background is updated by this frame.
+     * @param frame unfiltered frame
+     * @return false if the frame became the background
+     */
+    bool beginFrame(cv::Mat& frame) override;
+
     /**
-     * Apply background subtraction.
+     * Apply background subtraction to a band of the frame.
      * @param frame unfiltered frame
-     * @return filtered frame
+     * @param rows rows to filter
+     * @param input_rows unused
      */
-    void filter(cv::Mat& frame) override;
+    void filterBand(cv::Mat& frame,
+                    const cv::Range &rows,
+                    const cv::Range &input_rows) override;
 
     // Is the background frame set?
     bool background_set = false;
@@ -61,6 +87,16 @@ private:
 
     // Set the background frame
     void setBackgroundImage(const cv::Mat&);
+
+    // Adaptive background. The running average is kept in 8.8 fixed point so
+    // that update, subtraction and saturation are a single integer pass.
+    Mode mode_ {Mode::STATIC};
+    double learning_coeff_ {0.05};
+    int learning_coeff_q8_ {13};
+    int64_t update_interval_ {1};
+    int64_t frames_since_update_ {0};
+    bool update_ {false};
+    cv::Mat background_q8_;
 };
 
 }      /* namespace oat */
@@ -19,12 +19,15 @@
 
 #include "OatConfig.h" // Generated by CMake
 
+#include <iomanip>
+#include <iostream>
+#include <sstream>
 #include <stdexcept>
 #include <string>
-#include <iostream>
 #include <opencv2/cvconfig.h>
 #include <opencv2/core.hpp>
 #include <opencv2/highgui.hpp>
+#include <opencv2/imgproc.hpp>
 #include <opencv2/video/background_segm.hpp>
 #ifdef HAVE_CUDA
 #include <opencv2/cudabgsegm.hpp>
@@ -47,16 +50,24 @@ BackgroundSubtractorMOG::BackgroundSubtractorMOG(
 #ifdef HAVE_CUDA
     configureGPU(0);
     background_subtractor_ = cv::cuda::createBackgroundSubtractorMOG(/*defaults OK?*/);
-#else
-    background_subtractor_ = cv::createBackgroundSubtractorMOG2(/*defaults OK?*/);
 #endif
 }
 
+BackgroundSubtractorMOG::~BackgroundSubtractorMOG() {
+
+    if (report_timing_)
+        printTiming();
+}
+
 void BackgroundSubtractorMOG::configure(const std::string &config_file, const std::string &config_key) {
 
     // Available options
     std::vector<std::string> options {"gpu_index",
-                                      "learning_coeff"};
+                                      "learning_coeff",
+                                      "update_interval",
+                                      "scale",
+                                      "binary",
+                                      "timing"};
 
     // This will throw cpptoml::parse_exception if a file
     // with invalid TOML is provided
@@ -82,6 +93,21 @@ void BackgroundSubtractorMOG::configure(const std::string &config_file, const st
         // Learning coefficient
         oat::config::getValue(this_config, "learning_coeff", learning_coeff_, 0.0, 1.0);
 
+        // Number of frames between model updates
+        oat::config::getValue(this_config, "update_interval",
+                              update_interval_, (int64_t)1);
+
+        // Model resolution relative to the frame
+        oat::config::getValue(this_config, "scale", scale_, 0.0, 1.0);
+        if (scale_ <= 0.0)
+            throw (std::runtime_error("'scale' must be greater than 0."));
+
+        // Publish the foreground mask
+        oat::config::getValue(this_config, "binary", binary_);
+
+        // Report the time spent per frame on exit
+        oat::config::getValue(this_config, "timing", report_timing_);
+
     } else {
         throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
     }
@@ -110,18 +136,138 @@ void BackgroundSubtractorMOG::configureGPU(int64_t index) {
 }
 #endif
 
-void BackgroundSubtractorMOG::filter(cv::Mat &frame) {
+FrameFilter::FrameFormat
+BackgroundSubtractorMOG::outputFormat(const FrameFormat &source_format) const {
+
+    if (!binary_)
+        return source_format;
+
+    FrameFormat format = source_format;
+    format.type = CV_8UC1;
+    format.packed = true;
+
+    return format;
+}
+
+double BackgroundSubtractorMOG::nextLearningCoeff() {
+
+    // Frames between updates are classified against the model without
+    // changing it
+    if (++frames_since_update_ >= update_interval_) {
+        frames_since_update_ = 0;
+        return learning_coeff_;
+    }
+
+    return 0.0;
+}
+
+cv::Mat BackgroundSubtractorMOG::modelFrame(const cv::Mat &frame) {
+
+    // Learn and classify at reduced resolution
+    if (scale_ >= 1.0)
+        return frame;
+
+    cv::resize(frame, scaled_frame_, cv::Size(), scale_, scale_, cv::INTER_AREA);
+    return scaled_frame_;
+}
+
+void BackgroundSubtractorMOG::applyMask(cv::Mat &frame) {
+
+    cv::Mat mask = background_mask_;
+    if (scale_ < 1.0) {
+        cv::resize(background_mask_, full_mask_, frame.size(), 0, 0, cv::INTER_NEAREST);
+        mask = full_mask_;
+    }
+
+    if (binary_)
+        frame = mask;
+    else
+        frame.setTo(0, mask == 0);
+}
 
 #ifdef HAVE_CUDA
-    current_frame_.upload(frame);
-    background_subtractor_->apply(current_frame_, background_mask_, learning_coeff_);
-    cv::cuda::bitwise_not(background_mask_, background_mask_);
-    current_frame_.setTo(0, background_mask_);
-    current_frame_.download(frame);
+void BackgroundSubtractorMOG::filter(cv::Mat &frame) {
+
+    const auto start = Clock::now();
+    const std::clock_t cpu_start = std::clock();
+
+    const double learning_coeff = nextLearningCoeff();
+
+    current_frame_.upload(modelFrame(frame));
+    background_subtractor_->apply(current_frame_, gpu_mask_, learning_coeff);
+    gpu_mask_.download(background_mask_);
+
+    applyMask(frame);
+
+    wall_time_ += Clock::now() - start;
+    cpu_time_ += std::clock() - cpu_start;
+    frames_filtered_++;
+}
 #else
-    background_subtractor_->apply(frame, background_mask_, learning_coeff_);
-    frame.setTo(0, background_mask_ == 0);
+bool BackgroundSubtractorMOG::beginFrame(cv::Mat &frame) {
+
+    frame_start_ = Clock::now();
+    frame_cpu_start_ = std::clock();
+
+    frame_learning_coeff_ = nextLearningCoeff();
+    model_frame_ = modelFrame(frame);
+    background_mask_.create(model_frame_.size(), CV_8UC1);
+
+    // A frame is always split into the same bands, so each band keeps its
+    // own model
+    num_bands_ = numBands(frame.rows);
+    while (band_subtractors_.size() < static_cast<size_t>(num_bands_))
+        band_subtractors_.push_back(cv::createBackgroundSubtractorMOG2());
+
+    return true;
+}
+
+void BackgroundSubtractorMOG::filterBand(cv::Mat &frame,
+                                         const cv::Range &rows,
+                                         const cv::Range &) {
+
+    int i = 0;
+    while (i < num_bands_ - 1
+           && bandRows(i, num_bands_, frame.rows).start != rows.start)
+        i++;
+
+    // The model frame may have fewer rows than there are bands
+    const cv::Range model_rows = bandRows(i, num_bands_, model_frame_.rows);
+    if (model_rows.empty())
+        return;
+
+    // The band's mask is written in place
+    cv::Mat mask = background_mask_.rowRange(model_rows);
+    band_subtractors_[i]->apply(model_frame_.rowRange(model_rows),
+                                mask,
+                                frame_learning_coeff_);
+}
+
+void BackgroundSubtractorMOG::endFrame(cv::Mat &frame) {
+
+    applyMask(frame);
+
+    wall_time_ += Clock::now() - frame_start_;
+    cpu_time_ += std::clock() - frame_cpu_start_;
+    frames_filtered_++;
+}
 #endif
+
+void BackgroundSubtractorMOG::printTiming() const {
+
+    if (frames_filtered_ == 0)
+        return;
+
+    std::chrono::duration<double, std::milli> wall = wall_time_;
+    const double cpu = 1000.0 * cpu_time_ / CLOCKS_PER_SEC;
+
+    std::stringstream report;
+    report << std::fixed << std::setprecision(3)
+           << "Mean times over " << frames_filtered_ << " frames:\n"
+           << "  wall: " << wall.count() / frames_filtered_ << " ms\n"
+           << "  cpu: " << cpu / frames_filtered_ << " ms\n";
+
+    std::cout << oat::whoMessage(name(), report.str());
 }
 
 } /* namespace oat */
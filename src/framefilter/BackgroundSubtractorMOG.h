@@ -21,6 +21,9 @@
 #define	OAT_BACKGROUNDSUBTRACTORMOG_H
 
 
+#include <chrono>
+#include <ctime>
+#include <vector>
 #include <opencv2/cvconfig.h>
 
 #ifdef HAVE_CUDA
@@ -34,7 +37,9 @@
 namespace oat {
 
 /**
- * A MOG background subtractor.
+ * A MOG background subtractor. To reduce cost when the background is
+ * static, the model can be updated only every few frames, and the model can
+ * be learned and applied on downscaled frames.
  */
 class BackgroundSubtractorMOG : public FrameFilter {
 public:
@@ -47,11 +52,25 @@ public:
     BackgroundSubtractorMOG(const std::string &frame_souce_address,
                             const std::string &frame_sink_address);
 
+    ~BackgroundSubtractorMOG();
+
     void configure(const std::string &config_file,
                    const std::string &config_key) override;
 
 private:
 
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * Get the format of published frames, which are packed foreground
+     * masks if requested.
+     * @param source_format Format of SOURCE frames
+     * @return Format of published frames
+     */
+    FrameFormat outputFormat(const FrameFormat &source_format) const override;
+
+#ifdef HAVE_CUDA
+
     /**
      * Apply background subtraction.
      * @param frame unfiltered frame
@@ -59,8 +78,6 @@ private:
      */
     void filter(cv::Mat& frame) override;
 
-#ifdef HAVE_CUDA
-
      /**
      * Configure the GPU to perform background subtraction.
      * @param index_ Index of the GPU to use for processing
@@ -68,13 +85,90 @@ private:
     void configureGPU(int64_t index_);
 
     cv::Ptr<cv::cuda::BackgroundSubtractorMOG> background_subtractor_;
-    cv::cuda::GpuMat current_frame_, background_mask_;
+    cv::cuda::GpuMat current_frame_, gpu_mask_;
 #else
-    cv::Ptr<cv::BackgroundSubtractorMOG2> background_subtractor_;
-    cv::Mat background_mask_;
+
+    // MOG2 models each pixel independently, so frames can be processed in
+    // bands, each with its own model
+    bool bandable(void) const override { return true; }
+
+    /**
+     * Select the learning rate, downscale the frame and create one model
+     * per band on the first frame.
+     * @param frame unfiltered frame
+     * @return true
+     */
+    bool beginFrame(cv::Mat& frame) override;
+
+    /**
+     * Update and apply the model of a band.
+     * @param frame unfiltered frame
+     * @param rows rows of the band
+     * @param input_rows unused
+     */
+    void filterBand(cv::Mat& frame,
+                    const cv::Range &rows,
+                    const cv::Range &input_rows) override;
+
+    /**
+     * Apply the foreground mask to the frame.
+     * @param frame unfiltered frame
+     */
+    void endFrame(cv::Mat& frame) override;
+
+    // One model per band. The model of band i covers band i of the model
+    // frame, which may be downscaled.
+    std::vector<cv::Ptr<cv::BackgroundSubtractorMOG2>> band_subtractors_;
+    int num_bands_ {0};
+    cv::Mat model_frame_;
+    double frame_learning_coeff_ {0.0};
+    Clock::time_point frame_start_;
+    std::clock_t frame_cpu_start_ {0};
 #endif
 
+    /**
+     * Learning rate of the next frame, which is 0 between model updates.
+     */
+    double nextLearningCoeff(void);
+
+    /**
+     * Downscale a frame to model resolution.
+     * @param frame unfiltered frame
+     * @return frame at model resolution
+     */
+    cv::Mat modelFrame(const cv::Mat &frame);
+
+    /**
+     * Apply the foreground mask, at model resolution, to the frame.
+     * @param frame unfiltered frame
+     */
+    void applyMask(cv::Mat &frame);
+
+    // Foreground mask at model resolution and at frame resolution
+    cv::Mat background_mask_, full_mask_;
+
+    // Publish the foreground mask as a packed binary mask rather than the
+    // masked frame
+    bool binary_ {false};
+
     double learning_coeff_ {0.0};
+
+    // The model learns from every update_interval_'th frame. Other frames
+    // are only classified.
+    int64_t update_interval_ {1};
+    int64_t frames_since_update_ {0};
+
+    // Frames are downscaled by this factor before learning and
+    // classification. The foreground mask is upsampled to frame size.
+    double scale_ {1.0};
+    cv::Mat scaled_frame_;
+
+    // Mean wall and CPU time per frame, printed on exit
+    bool report_timing_ {false};
+    uint64_t frames_filtered_ {0};
+    Clock::duration wall_time_ {Clock::duration::zero()};
+    std::clock_t cpu_time_ {0};
+    void printTiming(void) const;
 };
 
 }      /* namespace oat */
@@ -0,0 +1,206 @@
+//******************************************************************************
+//* File:   FilterChain.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+
+#include "FilterChain.h"
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include <cpptoml.h>
+#include "../../lib/utility/OatTOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/make_unique.h"
+
+#include "BackgroundSubtractor.h"
+#include "BackgroundSubtractorMOG.h"
+#include "FrameConverter.h"
+#include "FrameMasker.h"
+#include "TemporalFilter.h"
+#include "Undistorter.h"
+
+namespace oat {
+
+FilterChain::FilterChain(const std::string &frame_source_address,
+                         const std::string &frame_sink_address) :
+  FrameFilter(frame_source_address, frame_sink_address)
+, frame_source_address_(frame_source_address)
+, frame_sink_address_(frame_sink_address)
+{
+    // Nothing
+}
+
+FilterChain::~FilterChain() {
+
+    if (report_timing_)
+        printTiming();
+}
+
+void FilterChain::configure(const std::string &config_file,
+                            const std::string &config_key) {
+
+    // Available options
+    std::vector<std::string> options {"stages", "configs", "timing"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    auto config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config->contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config->get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        // Filter TYPE of each stage, in order
+        oat::config::Array stage_array;
+        oat::config::getArray(this_config, "stages", stage_array, true);
+        for (auto &t : stage_array->array_of<std::string>())
+            stage_types_.push_back(t->get());
+
+        if (stage_types_.empty())
+            throw (std::runtime_error("A filter chain requires at least one stage."));
+
+        // Configuration table of each stage. Empty keys leave a stage
+        // unconfigured.
+        std::vector<std::string> config_keys(stage_types_.size());
+        oat::config::Array config_array;
+        if (oat::config::getArray(this_config, "configs", config_array,
+                                  stage_types_.size())) {
+            auto keys = config_array->array_of<std::string>();
+            for (size_t i = 0; i < keys.size(); i++)
+                config_keys[i] = keys[i]->get();
+        }
+
+        for (size_t i = 0; i < stage_types_.size(); i++) {
+
+            auto stage = makeStage(stage_types_[i]);
+            if (!config_keys[i].empty())
+                stage->configure(config_file, config_keys[i]);
+
+            stages_.push_back(std::move(stage));
+        }
+
+        stage_time_.assign(stages_.size(), Clock::duration::zero());
+
+        // Report the time spent in each stage on exit
+        oat::config::getValue(this_config, "timing", report_timing_);
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+std::unique_ptr<oat::FrameFilter>
+FilterChain::makeStage(const std::string &type) const {
+
+    if (type == "bsub")
+        return std::make_unique<oat::BackgroundSubtractor>(
+                frame_source_address_, frame_sink_address_);
+    else if (type == "mask")
+        return std::make_unique<oat::FrameMasker>(
+                frame_source_address_, frame_sink_address_);
+    else if (type == "mog")
+        return std::make_unique<oat::BackgroundSubtractorMOG>(
+                frame_source_address_, frame_sink_address_);
+    else if (type == "undistort")
+        return std::make_unique<oat::Undistorter>(
+                frame_source_address_, frame_sink_address_);
+    else if (type == "convert")
+        return std::make_unique<oat::FrameConverter>(
+                frame_source_address_, frame_sink_address_);
+    else if (type == "temporal")
+        return std::make_unique<oat::TemporalFilter>(
+                frame_source_address_, frame_sink_address_);
+
+    throw (std::runtime_error("Invalid filter chain stage TYPE '" + type + "'."));
+}
+
+FrameFilter::FrameFormat
+FilterChain::outputFormat(const FrameFormat &source_format) const {
+
+    if (stages_.empty())
+        throw (std::runtime_error("A filter chain requires a configuration "
+                                  "specifying its stages."));
+
+    // Only the last stage's output is published, so only it may be packed
+    FrameFormat format = source_format;
+    for (auto &s : stages_) {
+        format.packed = false;
+        format = s->outputFormat(format);
+    }
+
+    return format;
+}
+
+void FilterChain::filter(cv::Mat &frame) {
+
+    // Each stage works in place on the frame, or reassigns it to a buffer it
+    // owns, so no copies are made between stages. Stages that support
+    // banding are split across this component's threads.
+    if (!report_timing_) {
+
+        for (auto &s : stages_)
+            applyFilter(*s, frame);
+
+    } else {
+
+        for (size_t i = 0; i < stages_.size(); i++) {
+            auto start = Clock::now();
+            applyFilter(*stages_[i], frame);
+            stage_time_[i] += Clock::now() - start;
+        }
+
+        frames_filtered_++;
+    }
+}
+
+void FilterChain::printTiming() const {
+
+    if (frames_filtered_ == 0)
+        return;
+
+    std::chrono::duration<double, std::milli> total {0};
+
+    std::stringstream report;
+    report << std::fixed << std::setprecision(3)
+           << "Mean stage times over " << frames_filtered_ << " frames:\n";
+
+    for (size_t i = 0; i < stages_.size(); i++) {
+
+        std::chrono::duration<double, std::milli> t = stage_time_[i];
+        total += t;
+
+        report << "  " << i << " " << stage_types_[i] << ": "
+               << t.count() / frames_filtered_ << " ms\n";
+    }
+
+    report << "  total: " << total.count() / frames_filtered_ << " ms\n";
+
+    std::cout << oat::whoMessage(name(), report.str());
+}
+
+} /* namespace oat */
@@ -0,0 +1,88 @@
+//******************************************************************************
+//* File:   FilterChain.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+
+#ifndef OAT_FILTERCHAIN_H
+#define	OAT_FILTERCHAIN_H
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FrameFilter.h"
+
+namespace oat {
+
+/**
+ * An ordered chain of frame filters.
+ */
+class FilterChain : public FrameFilter {
+public:
+
+    /**
+     * An ordered chain of frame filters.
+     * Applies several filters back to back within one component so that
+     * intermediate results are not published to, and copied out of, shared
+     * memory. Only the output of the last stage is published.
+     * @param frame_source_address raw frame source address
+     * @param frame_sink_address filtered frame sink address
+     */
+    FilterChain(const std::string &frame_souce_address,
+                const std::string &frame_sink_address);
+
+    ~FilterChain();
+
+    void configure(const std::string &config_file,
+                   const std::string &config_key) override;
+
+private:
+
+    /**
+     * Get the format of frames produced by the last stage.
+     * @param source_format Format of SOURCE frames
+     * @return Format of filtered frames
+     */
+    FrameFormat outputFormat(const FrameFormat &source_format) const override;
+
+    /**
+     * Apply each stage in order.
+     * @param frame unfiltered frame
+     * @return filtered frame
+     */
+    void filter(cv::Mat& frame) override;
+
+    // Filter stages, in order. Stages are not connected to nodes and only
+    // use the addresses for naming.
+    const std::string frame_source_address_;
+    const std::string frame_sink_address_;
+    std::vector<std::string> stage_types_;
+    std::vector<std::unique_ptr<oat::FrameFilter>> stages_;
+    std::unique_ptr<oat::FrameFilter> makeStage(const std::string &type) const;
+
+    // Per-stage timing
+    using Clock = std::chrono::steady_clock;
+    bool report_timing_ {false};
+    uint64_t frames_filtered_ {0};
+    std::vector<Clock::duration> stage_time_;
+    void printTiming(void) const;
+};
+
+}      /* namespace oat */
+#endif /* OAT_FILTERCHAIN_H */
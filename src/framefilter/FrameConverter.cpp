@@ -0,0 +1,180 @@
+//******************************************************************************
+//* File:   FrameConverter.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+
+#include "FrameConverter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <cpptoml.h>
+#include "../../lib/utility/OatTOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+
+namespace oat {
+
+FrameConverter::FrameConverter(const std::string &frame_source_address,
+                               const std::string &frame_sink_address) :
+  FrameFilter(frame_source_address, frame_sink_address)
+{
+    // Nothing
+}
+
+void FrameConverter::configure(const std::string &config_file,
+                               const std::string &config_key) {
+
+    // Available options
+    std::vector<std::string> options {"scale",
+                                      "width",
+                                      "height",
+                                      "interpolation",
+                                      "color"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    auto config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config->contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config->get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        // Output size
+        oat::config::getValue(this_config, "scale", scale_, 0.0);
+
+        int64_t val;
+        if (oat::config::getValue(this_config, "width", val, (int64_t)1))
+            width_ = val;
+        if (oat::config::getValue(this_config, "height", val, (int64_t)1))
+            height_ = val;
+
+        if ((width_ == 0) != (height_ == 0))
+            throw (std::runtime_error("Both 'width' and 'height' must be specified."));
+
+        if (scale_ <= 0.0)
+            throw (std::runtime_error("'scale' must be greater than 0."));
+
+        std::string interp;
+        if (oat::config::getValue(this_config, "interpolation", interp)) {
+
+            if (interp == "area")
+                interpolation_ = cv::INTER_AREA;
+            else if (interp == "nearest")
+                interpolation_ = cv::INTER_NEAREST;
+            else if (interp == "linear")
+                interpolation_ = cv::INTER_LINEAR;
+            else
+                throw (std::runtime_error("Interpolation must be 'area', "
+                                          "'nearest', or 'linear'."));
+        }
+
+        // Output color space
+        std::string color;
+        if (oat::config::getValue(this_config, "color", color)) {
+
+            if (color == "same")
+                color_ = Color::SAME;
+            else if (color == "gray")
+                color_ = Color::GRAY;
+            else if (color == "hsv")
+                color_ = Color::HSV;
+            else
+                throw (std::runtime_error("Color must be 'same', 'gray', or "
+                                          "'hsv'."));
+        }
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+cv::Size FrameConverter::outputSize(const cv::Size &source_size) const {
+
+    if (width_ > 0)
+        return cv::Size(width_, height_);
+
+    return cv::Size(std::max(1, static_cast<int>(std::lround(source_size.width * scale_))),
+                    std::max(1, static_cast<int>(std::lround(source_size.height * scale_))));
+}
+
+FrameFilter::FrameFormat
+FrameConverter::outputFormat(const FrameFormat &source_format) const {
+
+    const cv::Size size = outputSize(cv::Size(source_format.cols,
+                                              source_format.rows));
+
+    FrameFormat format = source_format;
+    format.rows = size.height;
+    format.cols = size.width;
+
+    // Pixel centers of the resized frame map to the SOURCE frame as they do
+    // in cv::resize, so positions detected in resized frames can be mapped
+    // back to the full sensor frame
+    const double ratio_x = static_cast<double>(source_format.cols) / size.width;
+    const double ratio_y = static_cast<double>(source_format.rows) / size.height;
+    format.offset.x += 0.5 * source_format.scale.x * (ratio_x - 1.0);
+    format.offset.y += 0.5 * source_format.scale.y * (ratio_y - 1.0);
+    format.scale.x *= ratio_x;
+    format.scale.y *= ratio_y;
+
+    if (color_ != Color::SAME) {
+
+        if (source_format.type != CV_8UC3)
+            throw (std::runtime_error("Color conversion requires 8-bit, "
+                                      "3-channel BGR frames."));
+
+        format.type = color_ == Color::GRAY ? CV_8UC1 : CV_8UC3;
+    }
+
+    return format;
+}
+
+void FrameConverter::filter(cv::Mat &frame) {
+
+    // Resize first so that color conversion runs on fewer pixels. Integer
+    // downscaling factors use OpenCV's vectorized area-averaging path.
+    const cv::Size size = outputSize(frame.size());
+    if (size != frame.size()) {
+        cv::resize(frame, resized_frame_, size, 0, 0, interpolation_);
+        frame = resized_frame_;
+    }
+
+    switch (color_) {
+        case Color::SAME :
+            break;
+        case Color::GRAY :
+            cv::cvtColor(frame, converted_frame_, cv::COLOR_BGR2GRAY);
+            frame = converted_frame_;
+            break;
+        case Color::HSV :
+            cv::cvtColor(frame, converted_frame_, cv::COLOR_BGR2HSV);
+            frame = converted_frame_;
+            break;
+    }
+}
+
+} /* namespace oat */
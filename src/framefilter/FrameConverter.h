@@ -0,0 +1,92 @@
+//******************************************************************************
+//* File:   FrameConverter.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+
+#ifndef OAT_FRAMECONVERTER_H
+#define	OAT_FRAMECONVERTER_H
+
+#include <opencv2/core/mat.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "FrameFilter.h"
+
+namespace oat {
+
+/**
+ * Frame resizer and color space converter.
+ */
+class FrameConverter : public FrameFilter {
+public:
+
+    /**
+     * Frame resizer and color space converter.
+     * Resizes and/or converts the color space of frames once so that
+     * several downstream components can share the result rather than each
+     * converting privately.
+     * @param frame_source_address raw frame source address
+     * @param frame_sink_address filtered frame sink address
+     */
+    FrameConverter(const std::string &frame_souce_address,
+                   const std::string &frame_sink_address);
+
+    void configure(const std::string &config_file,
+                   const std::string &config_key) override;
+
+private:
+
+    /**
+     * Get the size and type of converted frames.
+     * @param source_format Format of SOURCE frames
+     * @return Format of converted frames
+     */
+    FrameFormat outputFormat(const FrameFormat &source_format) const override;
+
+    /**
+     * Resize and convert the frame.
+     * @param frame unconverted frame
+     * @return converted frame
+     */
+    void filter(cv::Mat& frame) override;
+
+    // Color space of converted frames
+    enum class Color
+    {
+        SAME, //!< No conversion
+        GRAY, //!< BGR to grayscale
+        HSV   //!< BGR to HSV
+    };
+
+    // Resizing. If width and height are not given, frames are scaled by
+    // scale_.
+    double scale_ {1.0};
+    int width_ {0};
+    int height_ {0};
+    int interpolation_ {cv::INTER_AREA};
+    cv::Size outputSize(const cv::Size &source_size) const;
+
+    // Color conversion
+    Color color_ {Color::SAME};
+
+    // Persistent output buffers
+    cv::Mat resized_frame_;
+    cv::Mat converted_frame_;
+};
+
+}      /* namespace oat */
+#endif /* OAT_FRAMECONVERTER_H */
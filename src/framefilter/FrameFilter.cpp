@@ -17,6 +17,7 @@
 //* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
 //******************************************************************************
 
+#include <algorithm>
 #include <string>
 #include <opencv2/cvconfig.h>
 #include <opencv2/core/mat.hpp>
@@ -24,6 +25,7 @@
 #include "../../lib/shmemdf/Source.h"
 #include "../../lib/shmemdf/Sink.h"
 #include "../../lib/shmemdf/SharedFrameHeader.h"
+#include "../../lib/utility/PackedMask.h"
 
 #include "FrameFilter.h"
 
@@ -50,9 +52,26 @@ void FrameFilter::connectToNode() {
     oat::Source<oat::SharedFrameHeader>::ConnectionParameters param =
             frame_source_.parameters();
 
+    FrameFormat source_format {static_cast<int>(param.rows),
+                               static_cast<int>(param.cols),
+                               static_cast<int>(param.type),
+                               cv::Point2d(param.offset_x, param.offset_y),
+                               cv::Point2d(param.scale_x, param.scale_y),
+                               false};
+    FrameFormat format = outputFormat(source_format);
+
     // Bind to sink node and create a shared cv::Mat
-    frame_sink_.bind(frame_sink_address_, param.bytes);
-    shared_frame_ = frame_sink_.retrieve(param.rows, param.cols, param.type);
+    packed_output_ = format.packed;
+    const int data_cols = packed_output_ ? oat::packedCols(format.cols) : format.cols;
+    frame_sink_.bind(frame_sink_address_,
+                     format.rows * data_cols * CV_ELEM_SIZE(format.type));
+    shared_frame_ = frame_sink_.retrieve(format.rows, format.cols, format.type,
+                                         format.offset.x, format.offset.y,
+                                         packed_output_,
+                                         format.scale.x, format.scale.y);
+
+    if (num_threads_ > 1)
+        band_pool_.reset(new oat::BandPool(num_threads_));
 }
 
 bool FrameFilter::processFrame() {
@@ -73,8 +92,11 @@ bool FrameFilter::processFrame() {
     ////////////////////////////
     //  END CRITICAL SECTION  //
 
-    // Mess with internal frame
-    filter(internal_frame_);
+    // Mess with internal frame. The filter may reassign its header, so a
+    // header is passed to keep internal_frame_'s buffer from being
+    // reallocated on the next read.
+    cv::Mat filtered_frame = internal_frame_;
+    applyFilter(*this, filtered_frame);
 
     // START CRITICAL SECTION //
     ////////////////////////////
@@ -82,7 +104,11 @@ bool FrameFilter::processFrame() {
     // Wait for sources to read
     frame_sink_.wait();
 
-    internal_frame_.copyTo(shared_frame_);
+    if (packed_output_)
+        oat::packMask(filtered_frame, shared_frame_);
+    else
+        filtered_frame.copyTo(shared_frame_);
+    shared_frame_.sample() = internal_frame_.sample();
 
     // Tell sources there is new data
     frame_sink_.post();
@@ -94,4 +120,40 @@ bool FrameFilter::processFrame() {
     return false;
 }
 
+void FrameFilter::filter(cv::Mat &frame) {
+
+    // Banded filters process the whole frame as a single band
+    if (beginFrame(frame)) {
+        const cv::Range all(0, frame.rows);
+        filterBand(frame, all, all);
+        endFrame(frame);
+    }
+}
+
+void FrameFilter::applyFilter(FrameFilter &f, cv::Mat &frame) {
+
+    if (!band_pool_ || !f.bandable()) {
+        f.filter(frame);
+        return;
+    }
+
+    f.band_workers_ = band_pool_->size();
+    if (!f.beginFrame(frame))
+        return;
+
+    const int num_bands = f.numBands(frame.rows);
+    const int halo = f.bandHalo();
+
+    band_pool_->run(num_bands, [&f, &frame, num_bands, halo](size_t i) {
+
+        const cv::Range rows = bandRows(i, num_bands, frame.rows);
+        const cv::Range input_rows(std::max(rows.start - halo, 0),
+                                   std::min(rows.end + halo, frame.rows));
+
+        f.filterBand(frame, rows, input_rows);
+    });
+
+    f.endFrame(frame);
+}
+
 } /* namespace oat */
@@ -20,11 +20,14 @@
 #ifndef OAT_FRAMEFILT_H
 #define	OAT_FRAMEFILT_H
 
+#include <algorithm>
+#include <memory>
 #include <string>
 
 #include "../../lib/datatypes/Frame.h"
 #include "../../lib/shmemdf/Source.h"
 #include "../../lib/shmemdf/Sink.h"
+#include "../../lib/utility/BandPool.h"
 
 namespace oat {
 
@@ -36,6 +39,10 @@ class SharedFrameHeader;
  * All concrete frame filter types implement this ABC.
  */
 class FrameFilter {
+
+    // Chains call the filtering methods of their stages directly
+    friend class FilterChain;
+
 public:
 
     /**
@@ -76,16 +83,134 @@ public:
      */
     std::string name(void) const { return name_; }
 
+    /**
+     * Set the number of threads used to filter bands of each frame in
+     * parallel. Only filters that support banding use more than one.
+     * @param num_threads Number of threads
+     */
+    void set_num_threads(const size_t num_threads) { num_threads_ = num_threads; }
+
 protected:
 
     /**
-     * Perform frame filtering.
+     * Geometry of frames published to SINK.
+     */
+    struct FrameFormat {
+        int rows;
+        int cols;
+        int type;
+        cv::Point2d offset; //!< Upper left pixel within the full sensor frame
+        cv::Point2d scale;  //!< Size of a pixel in full sensor frame pixels
+        bool packed;      //!< Published as a packed binary mask (CV_8UC1 only)
+    };
+
+    /**
+     * Get the format of filtered frames given the format of SOURCE frames.
+     * Filters that change frame geometry must override this.
+     * @param source_format Format of SOURCE frames
+     * @return Format of filtered frames
+     */
+    virtual FrameFormat outputFormat(const FrameFormat &source_format) const {
+        return source_format;
+    }
+
+    /**
+     * Perform frame filtering. The frame may be filtered in place or
+     * reassigned to a different matrix (e.g. a sub-region or a buffer owned
+     * by the filter) whose format matches outputFormat(). Filters that
+     * support banding need not override this: by default, the whole frame is
+     * filtered as a single band.
      * @param frame to be filtered
      */
-    virtual void filter(cv::Mat& frame) = 0;
+    virtual void filter(cv::Mat& frame);
+
+    /**
+     * Filters that can process horizontal bands of a frame independently
+     * return true and implement beginFrame(), filterBand() and endFrame()
+     * in place of filter(). Bands are then filtered in parallel when more
+     * than one thread is configured.
+     */
+    virtual bool bandable(void) const { return false; }
+
+    /**
+     * Number of rows above and below each band that a neighborhood
+     * operation reads. Filters with a non-zero halo must not filter in
+     * place, since neighboring bands read the rows they write.
+     */
+    virtual int bandHalo(void) const { return 0; }
+
+    /**
+     * Prepare to filter a frame's bands. Called once per frame before any
+     * band, from a single thread.
+     * @param frame to be filtered. May be reassigned to a sub-region.
+     * @return false if the frame requires no further filtering.
+     */
+    virtual bool beginFrame(cv::Mat&) { return true; }
+
+    /**
+     * Filter a band of the frame. Called concurrently for disjoint bands.
+     * @param frame to be filtered
+     * @param rows Rows of the result to produce
+     * @param input_rows Rows of frame that may be read, which are rows
+     * extended by bandHalo() and clipped to the frame.
+     */
+    virtual void filterBand(cv::Mat&,
+                            const cv::Range &,
+                            const cv::Range &) { }
+
+    /**
+     * Finish filtering a frame, e.g. by reassigning it to an output buffer.
+     * Called once per frame after all bands, from a single thread.
+     * @param frame to be filtered
+     */
+    virtual void endFrame(cv::Mat&) { }
+
+    /**
+     * Number of threads that may call filterBand() concurrently. Valid from
+     * beginFrame() on, e.g. to size per-thread scratch space.
+     */
+    size_t bandWorkers(void) const { return band_workers_; }
+
+    /**
+     * Index, in [0, bandWorkers()), of the thread calling filterBand().
+     */
+    static size_t bandWorker(void) { return oat::BandPool::workerIndex(); }
+
+    /**
+     * Number of bands a frame is split into. Valid from beginFrame() on.
+     * Frames of the same size are always split the same way, so filters may
+     * keep state per band.
+     * @param rows Rows of the frame
+     */
+    int numBands(const int rows) const {
+        return std::min<int>(band_workers_, rows);
+    }
+
+    /**
+     * Rows of band i of a frame split into num_bands bands.
+     * @param i Band index
+     * @param num_bands Number of bands
+     * @param rows Rows of the frame
+     */
+    static cv::Range bandRows(const int i, const int num_bands, const int rows) {
+        return cv::Range(rows * i / num_bands, rows * (i + 1) / num_bands);
+    }
+
+    /**
+     * Apply a filter to a frame, splitting it into bands across this
+     * component's threads if the filter supports banding.
+     * @param f Filter to apply (this filter or a stage it owns)
+     * @param frame to be filtered
+     */
+    void applyFilter(FrameFilter &f, cv::Mat& frame);
 
 private:
 
+    // Threads filtering bands in parallel
+    size_t num_threads_ {1};
+    std::unique_ptr<oat::BandPool> band_pool_;
+    size_t band_workers_ {1};
+
     // Filter name.
     const std::string name_;
 
@@ -102,6 +227,7 @@ private:
 
     // Currently acquired, shared frame
     oat::Frame shared_frame_;
+    bool packed_output_ {false};
 };
 
 }      /* namespace oat */
@@ -19,6 +19,10 @@
 
 #include "FrameMasker.h"
 
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
 #include <opencv2/core/mat.hpp>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/highgui.hpp>
@@ -29,6 +33,32 @@
 
 namespace oat {
 
+namespace {
+
+// Set pixels of the binary band to 255 where any channel of the frame band
+// is non-zero, and to 0 elsewhere.
+void binaryBand(const cv::Mat &band, cv::Mat binary) {
+
+    const int cn = band.channels();
+
+    for (int r = 0; r < band.rows; r++) {
+
+        const uint8_t * __restrict f = band.ptr<uint8_t>(r);
+        uint8_t * __restrict b = binary.ptr<uint8_t>(r);
+
+        for (int i = 0; i < band.cols; i++) {
+
+            uint8_t any = 0;
+            for (int c = 0; c < cn; c++)
+                any |= f[i * cn + c];
+
+            b[i] = any ? 255 : 0;
+        }
+    }
+}
+
+} /* namespace */
+
 FrameMasker::FrameMasker(const std::string &frame_source_address,
                          const std::string &frame_sink_address) :
   FrameFilter(frame_source_address, frame_sink_address)
@@ -40,7 +70,7 @@ void FrameMasker::configure(const std::string &config_file,
                             const std::string &config_key) {
 
     // Available options
-    std::vector<std::string> options {"mask"};
+    std::vector<std::string> options {"mask", "crop", "binary"};
 
     // This will throw cpptoml::parse_exception if a file
     // with invalid TOML is provided
@@ -64,17 +94,111 @@ void FrameMasker::configure(const std::string &config_file,
 
         mask_set_ = true;
 
+        // Bounding box of the ROI
+        oat::config::getValue(this_config, "crop", crop_);
+        if (crop_) {
+
+            std::vector<cv::Point> roi_points;
+            cv::findNonZero(roi_mask_, roi_points);
+            if (roi_points.empty())
+                throw (std::runtime_error("Mask \"" + mask_path + "\" has "
+                                          "no non-zero pixels to crop to."));
+
+            bounding_box_ = cv::boundingRect(roi_points);
+        }
+
+        // Publish a binary mask of the masked frame's non-zero pixels
+        oat::config::getValue(this_config, "binary", binary_);
+
     } else {
         throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
     }
 }
 
-void FrameMasker::filter(cv::Mat &frame) {
+FrameFilter::FrameFormat
+FrameMasker::outputFormat(const FrameFormat &source_format) const {
+
+    if (!mask_set_)
+        return source_format;
+
+    if (binary_ && CV_MAT_DEPTH(source_format.type) != CV_8U)
+        throw (std::runtime_error("Binary output requires 8-bit frames."));
+
+    if (roi_mask_.rows != source_format.rows
+        || roi_mask_.cols != source_format.cols)
+        throw (std::runtime_error("Mask size does not match SOURCE frame size."));
+
+    FrameFormat format = source_format;
+
+    // Offsets accumulate so positions can be mapped to the full sensor frame
+    if (crop_) {
+        format.rows = bounding_box_.height;
+        format.cols = bounding_box_.width;
+        format.offset.x += format.scale.x * bounding_box_.x;
+        format.offset.y += format.scale.y * bounding_box_.y;
+    }
+
+    if (binary_) {
+        format.type = CV_8UC1;
+        format.packed = true;
+    }
+
+    return format;
+}
+
+void FrameMasker::prepareMask(const cv::Mat &frame) {
+
+    cv::Mat mask = crop_ ? roi_mask_(bounding_box_) : roi_mask_;
+
+    use_and_ = frame.depth() == CV_8U;
+
+    if (use_and_) {
+        cv::Mat binary = mask != 0;
+        std::vector<cv::Mat> channels(frame.channels(), binary);
+        cv::merge(channels, frame_mask_);
+    } else {
+        frame_mask_ = mask == 0;
+    }
+}
+
+bool FrameMasker::beginFrame(cv::Mat &frame) {
 
     // Throws cv::Exception if there is a size mismatch between mask and frames
-    // received from SOURCE or in any case where setTo() assertions fail.
-    if (mask_set_)
-        frame.setTo(0, roi_mask_ == 0);
+    // received from SOURCE or in any case where assertions fail.
+    if (!mask_set_)
+        return false;
+
+    if (crop_)
+        frame = frame(bounding_box_);
+
+    if (frame_mask_.empty())
+        prepareMask(frame);
+
+    if (binary_)
+        binary_frame_.create(frame.size(), CV_8UC1);
+
+    return true;
+}
+
+void FrameMasker::filterBand(cv::Mat &frame,
+                             const cv::Range &rows,
+                             const cv::Range &) {
+
+    cv::Mat band = frame.rowRange(rows);
+
+    if (use_and_)
+        cv::bitwise_and(band, frame_mask_.rowRange(rows), band);
+    else
+        band.setTo(0, frame_mask_.rowRange(rows));
+
+    if (binary_)
+        binaryBand(band, binary_frame_.rowRange(rows));
+}
+
+void FrameMasker::endFrame(cv::Mat &frame) {
+
+    if (binary_)
+        frame = binary_frame_;
 }
 
 } /* namespace oat */
@@ -20,6 +20,8 @@
 #ifndef OAT_FRAMEMASKER_H
 #define	OAT_FRAMEMASKER_H
 
+#include <opencv2/core/mat.hpp>
+
 #include "FrameFilter.h"
 
 namespace oat {
@@ -35,6 +37,8 @@ public:
      * A frame masker to isolate one or more regions of interest in a frame stream using
      * a mask frame. Pixels of the input frames that correspond to non-zero pixels in
      * the mask frame will be unchanged. All other pixels will be set to 0.
+     * Optionally, only the bounding box of the mask's non-zero pixels is
+     * published.
      * @param frame_source_address raw frame source address
      * @param frame_sink_address filtered frame sink address
      */
@@ -48,17 +52,61 @@ public:
 private:
 
     /**
-     * Apply frame mask.
+     * Get the format of masked frames, which are cropped to the mask's
+     * bounding box if requested.
+     * @param source_format Format of SOURCE frames
+     * @return Format of masked frames
+     */
+    FrameFormat outputFormat(const FrameFormat &source_format) const override;
+
+    // Pixels are independent, so frames can be processed in bands
+    bool bandable(void) const override { return true; }
+
+    /**
+     * Crop the frame to the mask's bounding box, if requested, and prepare
+     * the mask for the frame format.
      * @param frame unfiltered frame
-     * @return filtered frame
+     * @return false if there is no mask to apply
      */
-    void filter(cv::Mat& frame) override;
+    bool beginFrame(cv::Mat& frame) override;
+
+    /**
+     * Apply frame mask to a band of the frame.
+     * @param frame unfiltered frame
+     * @param rows rows to filter
+     * @param input_rows unused
+     */
+    void filterBand(cv::Mat& frame,
+                    const cv::Range &rows,
+                    const cv::Range &input_rows) override;
+
+    /**
+     * Reassign the frame to its binary mask, if requested.
+     * @param frame masked frame
+     */
+    void endFrame(cv::Mat& frame) override;
 
     // Do we have a mask to work with
     bool mask_set_ = false;
 
     // Mask frames with an arbitrary ROI
     cv::Mat roi_mask_;
+
+    // Publish only the bounding box of the ROI
+    bool crop_ {false};
+    cv::Rect bounding_box_;
+
+    // Mask precomputed for the frame format (and cropped to the bounding box
+    // if requested). For 8-bit frames, this has a 0x00 or 0xFF value for
+    // every channel so that it can be applied with a single bitwise AND.
+    // Otherwise, it is the inverse mask used to zero pixels.
+    cv::Mat frame_mask_;
+    bool use_and_ {false};
+    void prepareMask(const cv::Mat &frame);
+
+    // Publish the non-zero pixels of masked frames as a packed binary mask
+    bool binary_ {false};
+    cv::Mat binary_frame_;
 };
 
 }      /* namespace oat */
@@ -0,0 +1,262 @@
+//******************************************************************************
+//* File:   TemporalFilter.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "TemporalFilter.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include <cpptoml.h>
+#include "../../lib/utility/OatTOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+
+namespace oat {
+
+namespace {
+
+// Longest history, limited by the 8-bit counts of the median histograms and
+// the 16-bit sum of the mean
+const int MAX_FRAMES {255};
+
+// Bins of the median histograms. Each covers 1 << BIN_SHIFT intensity
+// levels.
+const int BIN_SHIFT {4};
+const int NUM_BINS {256 >> BIN_SHIFT};
+
+// Replace a band of the frame with the mean of the history, after adding
+// the frame to the history and evicting the oldest frame, which shares its
+// ring slot. The division by the window length is a 16-bit fixed point
+// multiplication. Loops are written so that the compiler can vectorize them.
+template <bool Evict>
+void filterMean(cv::Mat &frame, cv::Mat &slot, cv::Mat &sum,
+                const cv::Range &rows, const int window) {
+
+    const int cols = frame.cols * frame.channels();
+    const uint32_t inv_q16 = (65536 + window / 2) / window;
+
+    for (int r = rows.start; r < rows.end; r++) {
+
+        uint8_t * __restrict f = frame.ptr<uint8_t>(r);
+        uint8_t * __restrict s = slot.ptr<uint8_t>(r);
+        uint16_t * __restrict a = sum.ptr<uint16_t>(r);
+
+        for (int i = 0; i < cols; i++) {
+
+            const uint32_t fi = f[i];
+            uint32_t ai = a[i] + fi;
+            if (Evict)
+                ai -= s[i];
+
+            a[i] = static_cast<uint16_t>(ai);
+            s[i] = static_cast<uint8_t>(fi);
+
+            const uint32_t m = (ai * inv_q16 + 32768) >> 16;
+            f[i] = static_cast<uint8_t>(m > 255 ? 255 : m);
+        }
+    }
+}
+
+// Replace a band of the frame with the approximate median of the history.
+// Each pixel's histogram is updated by moving one count from the evicted
+// value's bin to the new value's bin. The median is then located by a scan
+// over the bins, which is vectorized across the pixels of a row, and
+// interpolated within its bin assuming values are spread evenly. The
+// scratch row holds 4 * cols bytes.
+template <bool Evict>
+void filterMedian(cv::Mat &frame, cv::Mat &slot, cv::Mat &histogram,
+                  uint8_t *scratch, const cv::Range &rows, const int window) {
+
+    const int cols = frame.cols * frame.channels();
+    const size_t bin_step = histogram.step;
+    const uint8_t target = static_cast<uint8_t>((window + 1) / 2);
+
+    // Scratch rows: cumulative count, median bin, rank of the median within
+    // its bin, and count of the median's bin
+    uint8_t * __restrict cum = scratch;
+    uint8_t * __restrict bin = cum + cols;
+    uint8_t * __restrict rank = bin + cols;
+    uint8_t * __restrict n = rank + cols;
+
+    for (int r = rows.start; r < rows.end; r++) {
+
+        uint8_t * __restrict f = frame.ptr<uint8_t>(r);
+        uint8_t * __restrict s = slot.ptr<uint8_t>(r);
+        uint8_t * h = histogram.ptr<uint8_t>(r * NUM_BINS);
+
+        for (int i = 0; i < cols; i++) {
+
+            if (Evict)
+                h[(s[i] >> BIN_SHIFT) * bin_step + i]--;
+
+            h[(f[i] >> BIN_SHIFT) * bin_step + i]++;
+            s[i] = f[i];
+            cum[i] = 0;
+        }
+
+        for (int b = 0; b < NUM_BINS; b++) {
+
+            const uint8_t * __restrict hb = h + b * bin_step;
+
+            for (int i = 0; i < cols; i++) {
+
+                const uint8_t c = hb[i];
+                const uint8_t below = cum[i];
+                const bool sel = below < target && below + c >= target;
+
+                bin[i] = sel ? b : bin[i];
+                rank[i] = sel ? target - below : rank[i];
+                n[i] = sel ? c : n[i];
+                cum[i] = below + c;
+            }
+        }
+
+        for (int i = 0; i < cols; i++) {
+            const float within = (2 * rank[i] - 1) * (0.5f * (1 << BIN_SHIFT)) / n[i];
+            f[i] = static_cast<uint8_t>((bin[i] << BIN_SHIFT) + static_cast<int>(within));
+        }
+    }
+}
+
+} /* namespace */
+
+TemporalFilter::TemporalFilter(const std::string &frame_source_address,
+                               const std::string &frame_sink_address) :
+  FrameFilter(frame_source_address, frame_sink_address)
+{
+    // Nothing
+}
+
+void TemporalFilter::configure(const std::string &config_file,
+                               const std::string &config_key) {
+
+    // Available options
+    std::vector<std::string> options {"statistic", "frames"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    auto config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config->contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config->get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        std::string statistic;
+        if (oat::config::getValue(this_config, "statistic", statistic)) {
+
+            if (statistic == "mean")
+                statistic_ = Statistic::MEAN;
+            else if (statistic == "median")
+                statistic_ = Statistic::MEDIAN;
+            else
+                throw (std::runtime_error("Statistic must be 'mean' or 'median'."));
+        }
+
+        // History length
+        int64_t val;
+        if (oat::config::getValue(this_config, "frames", val,
+                                  (int64_t)1, (int64_t)MAX_FRAMES))
+            num_frames_ = val;
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+FrameFilter::FrameFormat
+TemporalFilter::outputFormat(const FrameFormat &source_format) const {
+
+    if (CV_MAT_DEPTH(source_format.type) != CV_8U)
+        throw (std::runtime_error("Temporal filtering requires 8-bit frames."));
+
+    return source_format;
+}
+
+bool TemporalFilter::beginFrame(cv::Mat& frame) {
+
+    // The history is allocated once, on the first frame
+    if (history_.empty()) {
+
+        history_.resize(num_frames_);
+        for (auto &h : history_)
+            h.create(frame.size(), frame.type());
+
+        const int cn = frame.channels();
+        if (statistic_ == Statistic::MEAN)
+            sum_ = cv::Mat::zeros(frame.size(), CV_16UC(cn));
+        else
+            histogram_ = cv::Mat::zeros(frame.rows * NUM_BINS, frame.cols, CV_8UC(cn));
+    }
+
+    // One median scratch row per band thread. This only allocates on the
+    // first frame.
+    if (statistic_ == Statistic::MEDIAN)
+        scratch_.create(bandWorkers(), 4 * frame.cols * frame.channels(), CV_8UC1);
+
+    CV_Assert(frame.size() == history_[0].size()
+              && frame.type() == history_[0].type());
+
+    // Once the ring is full, the current frame replaces the oldest
+    evict_ = count_ == num_frames_;
+    window_ = evict_ ? count_ : count_ + 1;
+
+    return true;
+}
+
+void TemporalFilter::filterBand(cv::Mat& frame,
+                                const cv::Range &rows,
+                                const cv::Range &) {
+
+    cv::Mat &slot = history_[slot_];
+
+    switch (statistic_) {
+        case Statistic::MEAN :
+        {
+            if (evict_)
+                filterMean<true>(frame, slot, sum_, rows, window_);
+            else
+                filterMean<false>(frame, slot, sum_, rows, window_);
+            break;
+        }
+        case Statistic::MEDIAN :
+        {
+            uint8_t *scratch = scratch_.ptr<uint8_t>(bandWorker());
+            if (evict_)
+                filterMedian<true>(frame, slot, histogram_, scratch, rows, window_);
+            else
+                filterMedian<false>(frame, slot, histogram_, scratch, rows, window_);
+            break;
+        }
+    }
+}
+
+void TemporalFilter::endFrame(cv::Mat &) {
+
+    slot_ = (slot_ + 1) % num_frames_;
+    if (count_ < num_frames_)
+        count_++;
+}
+
+} /* namespace oat */
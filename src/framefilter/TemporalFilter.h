@@ -0,0 +1,119 @@
+//******************************************************************************
+//* File:   TemporalFilter.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_TEMPORALFILTER_H
+#define	OAT_TEMPORALFILTER_H
+
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "FrameFilter.h"
+
+namespace oat {
+
+/**
+ * Temporal denoising filter. Each pixel is replaced by the mean or the
+ * approximate median of its value over the last N frames, which are kept in
+ * a preallocated ring. Both statistics are updated incrementally so that the
+ * cost per frame does not depend on N.
+ */
+class TemporalFilter : public FrameFilter {
+public:
+
+    /**
+     * Temporal denoising filter.
+     * @param frame_source_address raw frame source address
+     * @param frame_sink_address filtered frame sink address
+     */
+    TemporalFilter(const std::string &frame_souce_address,
+                   const std::string &frame_sink_address);
+
+    void configure(const std::string &config_file,
+                   const std::string &config_key) override;
+
+private:
+
+    // Temporal statistic
+    enum class Statistic
+    {
+        MEAN,   //!< Running mean
+        MEDIAN  //!< Approximate running median
+    };
+
+    /**
+     * Check that SOURCE frames are 8-bit.
+     * @param source_format Format of SOURCE frames
+     * @return Format of filtered frames, which is unchanged
+     */
+    FrameFormat outputFormat(const FrameFormat &source_format) const override;
+
+    // Pixels are independent, so frames can be processed in bands
+    bool bandable(void) const override { return true; }
+
+    /**
+     * Allocate the history and scratch space on the first frame and select
+     * the ring slot that the frame replaces.
+     * @param frame unfiltered frame
+     * @return true
+     */
+    bool beginFrame(cv::Mat& frame) override;
+
+    /**
+     * Add a band of the frame to the history, evict the oldest frame and
+     * replace the band with the temporal statistic.
+     * @param frame unfiltered frame
+     * @param rows rows to filter
+     * @param input_rows unused
+     */
+    void filterBand(cv::Mat& frame,
+                    const cv::Range &rows,
+                    const cv::Range &input_rows) override;
+
+    /**
+     * Advance the ring.
+     * @param frame filtered frame
+     */
+    void endFrame(cv::Mat& frame) override;
+
+    Statistic statistic_ {Statistic::MEAN};
+    int num_frames_ {5};
+
+    // Ring of the last num_frames_ frames. slot_ holds the oldest frame,
+    // which the current frame replaces once the ring is full.
+    std::vector<cv::Mat> history_;
+    int slot_ {0};
+    int count_ {0};
+    bool evict_ {false};
+
+    // Number of frames summarized by the current output
+    int window_ {1};
+
+    // Running sum of the history (mean)
+    cv::Mat sum_;
+
+    // Per-pixel, coarse histograms of the history (median). Each frame row
+    // is followed by one histogram row per bin.
+    cv::Mat histogram_;
+
+    // Median scratch space, one row per band thread
+    cv::Mat scratch_;
+};
+
+}      /* namespace oat */
+#endif /* OAT_TEMPORALFILTER_H */
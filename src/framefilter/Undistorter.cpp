@@ -18,6 +18,7 @@
 //******************************************************************************
 
 #include <string>
+#include <vector>
 
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
@@ -106,35 +107,93 @@ void Undistorter::configure(const std::string &config_file,
     }
 }
 
-void Undistorter::filter(cv::Mat& frame) {
+void Undistorter::buildMap(const cv::Size &size) {
 
-    cv::Mat temp = frame.clone();
+    // Rotation about the frame center, as applied after undistortion. Output
+    // pixels are taken back through its inverse to undistorted pixels.
+    cv::Matx23d inverse_rotation(1, 0, 0, 0, 1, 0);
+    if (rotation_deg_ != 0.0) {
+        cv::Point center = cv::Point(size.width/2, size.height/2);
+        cv::Mat rotation = cv::getRotationMatrix2D(center, rotation_deg_, 1.0);
+        cv::invertAffineTransform(rotation, inverse_rotation);
+    }
 
-    switch (camera_model_) {
-        case CameraModel::PINHOLE :
-        {
-            cv::undistort(temp, frame, camera_matrix_, distortion_coefficients_);
-            break;
-        }
-        case CameraModel::FISHEYE :
-        {
-            cv::fisheye::undistortImage(temp, frame, camera_matrix_,
-                    distortion_coefficients_, cv::Matx33d::eye());
-            break;
+    // New camera matrix of the undistorted image. These match the defaults
+    // of cv::undistort and the identity used with cv::fisheye::undistortImage.
+    const cv::Matx33d new_camera_inv = camera_model_ == CameraModel::PINHOLE
+                                       ? camera_matrix_.inv()
+                                       : cv::Matx33d::eye();
+
+    cv::Mat map(size, CV_32FC2);
+    std::vector<cv::Point3d> object_points(size.width);
+    std::vector<cv::Point2d> normalized_points(size.width);
+    std::vector<cv::Point2d> image_points;
+
+    for (int y = 0; y < size.height; y++) {
+
+        // Normalized, undistorted coordinates of each output pixel in the row
+        for (int x = 0; x < size.width; x++) {
+            const cv::Vec2d u = inverse_rotation * cv::Vec3d(x, y, 1.0);
+            const cv::Vec3d n = new_camera_inv * cv::Vec3d(u[0], u[1], 1.0);
+            normalized_points[x] = cv::Point2d(n[0] / n[2], n[1] / n[2]);
+            object_points[x] = cv::Point3d(normalized_points[x].x,
+                                           normalized_points[x].y,
+                                           1.0);
         }
-        default :
-        {
-            throw std::runtime_error("Invalid camera model selection.\n");
-            break;
+
+        // Apply the lens distortion model to find the source pixels
+        switch (camera_model_) {
+            case CameraModel::PINHOLE :
+            {
+                cv::projectPoints(object_points, cv::Vec3d(), cv::Vec3d(),
+                        camera_matrix_, distortion_coefficients_, image_points);
+                break;
+            }
+            case CameraModel::FISHEYE :
+            {
+                cv::fisheye::distortPoints(normalized_points, image_points,
+                        camera_matrix_, distortion_coefficients_);
+                break;
+            }
+            default :
+            {
+                throw std::runtime_error("Invalid camera model selection.\n");
+                break;
+            }
         }
-    }
 
-    if (rotation_deg_ != 0.0) {
-        cv::Point center = cv::Point(frame.cols/2, frame.rows/2 );
-        rotation_matrix_ = cv::getRotationMatrix2D(center, rotation_deg_, 1.0);
-        cv::warpAffine(frame, frame, rotation_matrix_, frame.size());
+        cv::Vec2f *row = map.ptr<cv::Vec2f>(y);
+        for (int x = 0; x < size.width; x++)
+            row[x] = cv::Vec2f(image_points[x].x, image_points[x].y);
     }
 
+    // Fixed-point maps are smaller and faster to apply
+    cv::convertMaps(map, cv::noArray(), map_xy_, map_interp_, CV_16SC2);
+}
+
+bool Undistorter::beginFrame(cv::Mat& frame) {
+
+    if (map_xy_.size() != frame.size())
+        buildMap(frame.size());
+
+    // Single pass for undistortion and rotation into a persistent buffer
+    remapped_frame_.create(frame.size(), frame.type());
+
+    return true;
+}
+
+void Undistorter::filterBand(cv::Mat& frame,
+                             const cv::Range &rows,
+                             const cv::Range &) {
+
+    cv::Mat band = remapped_frame_.rowRange(rows);
+    cv::remap(frame, band, map_xy_.rowRange(rows), map_interp_.rowRange(rows),
+              cv::INTER_LINEAR, cv::BORDER_CONSTANT);
+}
+
+void Undistorter::endFrame(cv::Mat& frame) {
+
+    frame = remapped_frame_;
 }
 
 } /* namespace oat */
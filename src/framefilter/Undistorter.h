@@ -61,12 +61,32 @@ private:
         FISHEYE =  1   //!< Fisheye lens model
     };
 
+    // Output rows are independent, so frames can be processed in bands
+    bool bandable(void) const override { return true; }
+
     /**
-     * Apply undistortion filter.
+     * Build the remap for the frame size, if necessary.
      * @param frame Unfiltered frame
-     * @return Filtered frame
+     * @return true
      */
-    void filter(cv::Mat& frame) override;
+    bool beginFrame(cv::Mat& frame) override;
+
+    /**
+     * Apply undistortion to a band of the output. Reads from anywhere in
+     * the frame, so the output is written to a separate buffer.
+     * @param frame Unfiltered frame
+     * @param rows Output rows to produce
+     * @param input_rows unused
+     */
+    void filterBand(cv::Mat& frame,
+                    const cv::Range &rows,
+                    const cv::Range &input_rows) override;
+
+    /**
+     * Replace the frame with the undistorted output.
+     * @param frame Unfiltered frame
+     */
+    void endFrame(cv::Mat& frame) override;
 
     CameraModel camera_model_ {CameraModel::PINHOLE};
     cv::Matx33d camera_matrix_  {cv::Matx33d::eye()};
@@ -74,7 +94,18 @@ private:
 
     // Negative implied no rotation
     double rotation_deg_ = 0.0;
-    cv::Matx23d rotation_matrix_; 
+
+    // Combined undistortion and rotation map in fixed-point form. Built once
+    // the frame size is known and rebuilt only if it changes.
+    cv::Mat map_xy_, map_interp_;
+    cv::Mat remapped_frame_;
+
+    /**
+     * Build the map taking each output pixel through the inverse rotation
+     * and then the lens distortion model to its source pixel.
+     * @param size Frame size
+     */
+    void buildMap(const cv::Size &size);
 };
 
 }      /* namespace oat */
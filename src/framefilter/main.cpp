@@ -36,6 +36,9 @@
 #include "BackgroundSubtractorMOG.h"
 #include "FrameMasker.h"
 #include "Undistorter.h"
+#include "FilterChain.h"
+#include "FrameConverter.h"
+#include "TemporalFilter.h"
 
 namespace po = boost::program_options;
 
@@ -51,7 +54,10 @@ void printUsage(po::options_description options){
               << "  bsub: Background subtraction\n"
               << "  mask: Binary mask\n"
               << "  mog: Mixture of Gaussians background segmentation.\n"
-              << "  undistort: Compensate for lens distortion using distortion model.\n\n"
+              << "  undistort: Compensate for lens distortion using distortion model.\n"
+              << "  convert: Resize and/or convert color space.\n"
+              << "  temporal: Temporal mean or median of recent frames.\n"
+              << "  chain: Several of the above applied in order within one process.\n\n"
               << "SOURCE:\n"
               << "  User-supplied name of the memory segment to receive frames "
               << "from (e.g. raw).\n\n"
@@ -95,6 +101,7 @@ int main(int argc, char *argv[]) {
     std::string sink;
     std::vector<std::string> config_fk;
     bool config_used = false;
+    size_t num_threads = 1;
     po::options_description visible_options("OPTIONS");
 
     std::unordered_map<std::string, char> type_hash;
@@ -102,6 +109,9 @@ int main(int argc, char *argv[]) {
     type_hash["mask"] = 'b';
     type_hash["mog"] = 'c';
     type_hash["undistort"] = 'd';
+    type_hash["chain"] = 'e';
+    type_hash["convert"] = 'f';
+    type_hash["temporal"] = 'g';
 
     try {
 
@@ -115,6 +125,11 @@ int main(int argc, char *argv[]) {
         config.add_options()
                 ("config,c", po::value<std::vector<std::string> >()->multitoken(),
                 "Configuration file/key pair.")
+                ("threads,t", po::value<size_t>(&num_threads),
+                "Number of threads used to filter bands of each frame in parallel. "
+                "Used by bsub, mog (without CUDA), mask, undistort, and temporal, "
+                "including as chain stages. "
+                "Defaults to 1.")
                 ;
 
         po::options_description hidden("HIDDEN OPTIONS");
@@ -125,7 +140,10 @@ int main(int argc, char *argv[]) {
                 "  bsub: Background subtractor.\n"
                 "  mask: Binary mask.\n"
                 "  mog: Mixture of Gaussians background segmentation.\n"
-                "  undistort: Compensate for lens distortion using distortion model.\n")
+                "  undistort: Compensate for lens distortion using distortion model.\n"
+                "  convert: Resize and/or convert color space.\n"
+                "  temporal: Temporal mean or median of recent frames.\n"
+                "  chain: Several of the above applied in order within one process.\n")
                 ("source", po::value<std::string>(&source),
                 "The name of the SOURCE that supplies images on which to perform background subtraction."
                 "The server must be of type SMServer<SharedCVMatHeader>\n")
@@ -240,6 +258,31 @@ int main(int argc, char *argv[]) {
                          " This filter does nothing but waste CPU cycles.\n");
             break;
         }
+        case 'e':
+        {
+            filter = std::make_shared<oat::FilterChain>(source, sink);
+            if (!config_used) {
+                std::cerr << oat::whoError(filter->name(),
+                        "A filter chain requires a configuration specifying"
+                        " its stages.\n");
+                return -1;
+            }
+            break;
+        }
+        case 'f':
+        {
+            filter = std::make_shared<oat::FrameConverter>(source, sink);
+            if (!config_used)
+                 std::cerr << oat::whoWarn(filter->name(),
+                         "No conversion configuration was provided."
+                         " This filter does nothing but waste CPU cycles.\n");
+            break;
+        }
+        case 'g':
+        {
+            filter = std::make_shared<oat::TemporalFilter>(source, sink);
+            break;
+        }
         default:
         {
             printUsage(visible_options);
@@ -254,6 +297,8 @@ int main(int argc, char *argv[]) {
         if (config_used)
             filter->configure(config_fk[0], config_fk[1]);
 
+        filter->set_num_threads(num_threads);
+
         // Tell user
         std::cout << oat::whoMessage(filter->name(),
                 "Listening to source " + oat::sourceText(source) + ".\n")
@@ -17,7 +17,10 @@
 //* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
 //******************************************************************************
 
+#include <algorithm>
 #include <chrono>
+#include <iostream>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <opencv2/videoio.hpp>
@@ -41,7 +44,25 @@ FileReader::FileReader(const std::string &image_sink_address,
 
     // Default config
     calculateFramePeriod();
-    tick_ = clock_.now();
+}
+
+FileReader::~FileReader() {
+
+    // Release any decode threads waiting on a free slot and join them
+    {
+        std::lock_guard<std::mutex> lk(decode_mutex_);
+        decoding_ = false;
+    }
+
+    slot_free_cv_.notify_all();
+
+    for (auto &t : decode_threads_) {
+        if (t.joinable())
+            t.join();
+    }
+
+    if (unthrottled_)
+        printThroughput();
 }
 
 void FileReader::connectToNode() {
@@ -65,44 +86,179 @@ void FileReader::connectToNode() {
 
     // Put the sample rate in the shared frame
     shared_frame_.sample().set_period_sec(frame_period_in_sec_.count());
+
+    // Start decoding ahead of the serving loop
+    decode_slots_.resize(prefetch_depth_);
+    slot_frame_.assign(prefetch_depth_, -1);
+    decoding_ = true;
+
+    if (num_decode_threads_ == 1) {
+        decode_threads_.emplace_back(&FileReader::decodeFrames, this);
+    } else {
+        for (int64_t i = 0; i < num_decode_threads_; i++)
+            decode_threads_.emplace_back(&FileReader::decodeSegments, this);
+    }
+}
+
+void FileReader::decodeFrames() {
+
+    int64_t frame = 0;
+    while (decodeFrame(file_reader_, frame))
+        frame++;
+}
+
+void FileReader::decodeSegments() {
+
+    // Each thread needs its own decoder state
+    cv::VideoCapture reader(file_name_);
+    int64_t position = 0;
+
+    while (decoding_) {
+
+        const int64_t first = segment_length_ * next_segment_++;
+        const int64_t last = first + segment_length_;
+
+        skipTo(reader, position, first);
+
+        for (position = first; position < last; position++) {
+            if (!decodeFrame(reader, position))
+                return;
+        }
+    }
+}
+
+void FileReader::skipTo(cv::VideoCapture &reader, int64_t position,
+                        const int64_t frame) {
+
+    // Segments are claimed in increasing order, so a thread only skips
+    // forward. Backends seek to the preceding keyframe and decode forward to
+    // the requested frame, so only seek when this segment does not continue
+    // directly from the previous one.
+    if (frame == position)
+        return;
+
+    // Seeking is not frame accurate for every backend and codec, so the
+    // position reported after a seek is checked. After the first miss, frames
+    // are skipped by decoding forward instead, which is accurate but slow.
+    if (exact_seek_) {
+
+        reader.set(CV_CAP_PROP_POS_FRAMES, static_cast<double>(frame));
+        if (static_cast<int64_t>(reader.get(CV_CAP_PROP_POS_FRAMES)) == frame)
+            return;
+
+        if (exact_seek_.exchange(false))
+            std::cerr << oat::whoWarn(name_,
+                "Seeking in " + file_name_ + " is not frame accurate. "
+                "Segments will be reached by decoding forward from the "
+                "start of the file.\n");
+
+        reader.open(file_name_);
+        position = 0;
+    }
+
+    // Past the end of the file, the next read fails and records the end
+    while (position < frame && reader.grab())
+        position++;
+}
+
+bool FileReader::decodeFrame(cv::VideoCapture &reader, const int64_t frame) {
+
+    const int64_t window = static_cast<int64_t>(decode_slots_.size());
+    const size_t slot = frame % window;
+
+    // Wait until the previous occupant of this slot has been published
+    {
+        std::unique_lock<std::mutex> lk(decode_mutex_);
+        slot_free_cv_.wait(lk, [this, frame, window] {
+            return !decoding_
+                   || frame >= eof_frame_
+                   || frame < next_frame_ + window;
+        });
+
+        if (!decoding_ || frame >= eof_frame_)
+            return false;
+    }
+
+    // Decode into the free slot. No locks are held here so the serving
+    // loop and other decode threads can proceed in the meantime.
+    reader >> decode_slots_[slot];
+
+    bool decoded = true;
+    {
+        std::lock_guard<std::mutex> lk(decode_mutex_);
+
+        if (decode_slots_[slot].empty()) {
+            eof_frame_ = std::min(eof_frame_, frame);
+            decoded = false;
+        } else {
+            slot_frame_[slot] = frame;
+        }
+    }
+
+    frame_ready_cv_.notify_one();
+
+    return decoded;
 }
 
 bool FileReader::serveFrame() {
 
+    const size_t slot = next_frame_ % decode_slots_.size();
+
+    // Wait for the next frame in sequence to be decoded. This occurs outside
+    // the critical section so that decode time is not imposed on SOURCEs.
+    {
+        std::unique_lock<std::mutex> lk(decode_mutex_);
+        frame_ready_cv_.wait(lk, [this, slot] {
+            return slot_frame_[slot] == next_frame_ || next_frame_ >= eof_frame_;
+        });
+
+        // All frames up to the end of the file have been published
+        frame_empty_ = next_frame_ >= eof_frame_;
+    }
+
+    if (frame_empty_)
+        return true;
+
+    const cv::Mat &frame = decode_slots_[slot];
+
+    if (next_frame_ == 0)
+        start_ = Clock::now();
+
     // START CRITICAL SECTION //
     ////////////////////////////
 
     // Wait for sources to read
     frame_sink_.wait();
 
+    // Publish the decoded frame, cropping if necessary
+    if (!use_roi_)
+        frame.copyTo(shared_frame_);
+    else
+        frame(region_of_interest_).copyTo(shared_frame_);
 
-    // Crop if necessary
-    if (!use_roi_) {
-            
-        file_reader_ >> shared_frame_;
-        frame_empty_ = shared_frame_.empty();
+    // Increment sample count and tell sources there is new data
+    postFrame();
 
-    } else {
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
 
-        oat::Frame to_crop;
-        file_reader_ >> to_crop;
-        if (!(frame_empty_ = to_crop.empty()))
-            to_crop = to_crop(region_of_interest_);
-        to_crop.copyTo(shared_frame_);
+    // Release the slot to the decode threads
+    {
+        std::lock_guard<std::mutex> lk(decode_mutex_);
+        slot_frame_[slot] = -1;
+        next_frame_++;
     }
 
-    // Increment sample count
-    shared_frame_.sample().incrementCount();
-
-    // Tell sources there is new data
-    frame_sink_.post();
+    slot_free_cv_.notify_all();
 
-    ////////////////////////////
-    //  END CRITICAL SECTION  //
+    stop_ = Clock::now();
 
-    // Enforce the correct frame rate
-    std::this_thread::sleep_for(frame_period_in_sec_ - (clock_.now() - tick_));
-    tick_ = clock_.now();
+    // Enforce the correct frame rate against an absolute deadline
+    if (!unthrottled_) {
+        std::this_thread::sleep_until(start_ +
+            std::chrono::duration_cast<Clock::duration>(
+                frame_period_in_sec_ * next_frame_));
+    }
 
     return frame_empty_;
 }
@@ -113,7 +269,12 @@ void FileReader::configure(const std::string& config_file,
                            const std::string& config_key) {
 
     // Available options
-    std::vector<std::string> options {"fps", "roi"};
+    std::vector<std::string> options {"fps",
+                                      "unthrottled",
+                                      "roi",
+                                      "prefetch",
+                                      "decode_threads",
+                                      "segment_length"};
 
     // This will throw cpptoml::parse_exception if a file
     // with invalid TOML is provided
@@ -132,6 +293,30 @@ void FileReader::configure(const std::string& config_file,
         oat::config::getValue(this_config, "fps", frame_rate_in_hz_, 0.0);
         calculateFramePeriod();
 
+        // Ignore the frame rate and publish as quickly as SOURCEs allow
+        oat::config::getValue(this_config, "unthrottled", unthrottled_);
+
+        // Parallel segment decoding
+        oat::config::getValue(this_config, "decode_threads",
+                              num_decode_threads_, (int64_t)1);
+        oat::config::getValue(this_config, "segment_length",
+                              segment_length_, (int64_t)1);
+
+        // Number of frames to decode ahead of the serving loop. When several
+        // threads decode in parallel, this is the reorder window. A thread
+        // cannot decode further ahead than the window, so it defaults to one
+        // segment per thread, which lets all of them make progress.
+        if (!oat::config::getValue(this_config, "prefetch",
+                                   prefetch_depth_, (int64_t)1)
+            && num_decode_threads_ > 1)
+            prefetch_depth_ = num_decode_threads_ * segment_length_;
+
+        if (num_decode_threads_ > 1
+            && prefetch_depth_ < num_decode_threads_ * segment_length_)
+            std::cerr << oat::whoWarn(name_,
+                "prefetch is less than decode_threads * segment_length, so "
+                "some decode threads will wait for the window.\n");
+
         // Set the ROI
         oat::config::Table roi;
         if (oat::config::getTable(this_config, "roi", roi)) {
@@ -161,4 +346,18 @@ void FileReader::calculateFramePeriod() {
     frame_period_in_sec_ = frame_period;
 }
 
+void FileReader::printThroughput() {
+
+    if (next_frame_ == 0)
+        return;
+
+    std::chrono::duration<double> elapsed = stop_ - start_;
+    double fps = elapsed.count() > 0.0 ? (next_frame_ - 1) / elapsed.count() : 0.0;
+
+    std::cout << oat::whoMessage(name_,
+                 "Served " + std::to_string(next_frame_) + " frames in "
+                 + std::to_string(elapsed.count()) + " seconds ("
+                 + std::to_string(fps) + " FPS).\n");
+}
+
 } /* namespace oat */
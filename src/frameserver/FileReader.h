@@ -20,9 +20,14 @@
 #ifndef OAT_FILEREADER_H
 #define	OAT_FILEREADER_H
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <limits>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 #include <opencv2/videoio.hpp>
 
 #include "FrameServer.h"
@@ -36,6 +41,8 @@ public:
                const std::string &image_sink_name,
                const double frames_per_second = std::numeric_limits<double>::max());
 
+    ~FileReader();
+
     // Implement FrameServer interface
     void configure(void) override;
     void configure(const std::string &config_file, 
@@ -49,14 +56,45 @@ private:
     std::string file_name_;
     cv::VideoCapture file_reader_;
 
-    // Playback speed
+    // Decode threads. Frames are decoded ahead of the serving loop into a
+    // ring of slots: frame n is decoded into slot n % prefetch_depth_ and
+    // slots are published strictly in frame order. With a single decode
+    // thread the file is read sequentially. With several, each thread
+    // claims the next segment of segment_length_ frames, seeks to it using
+    // its own capture, and the ring acts as a reorder window that bounds
+    // how far decoding can run ahead of publication. The window holds
+    // prefetch_depth_ decoded frames, so its default is kept small.
+    int64_t prefetch_depth_ {8};
+    int64_t num_decode_threads_ {1};
+    int64_t segment_length_ {8};
+    std::vector<cv::Mat> decode_slots_;
+    std::vector<int64_t> slot_frame_;
+    int64_t next_frame_ {0};
+    int64_t eof_frame_ {std::numeric_limits<int64_t>::max()};
+    std::atomic<int64_t> next_segment_ {0};
+    std::atomic<bool> exact_seek_ {true};
+    std::atomic<bool> decoding_ {false};
+    std::vector<std::thread> decode_threads_;
+    std::mutex decode_mutex_;
+    std::condition_variable frame_ready_cv_;
+    std::condition_variable slot_free_cv_;
+    void decodeFrames(void);
+    void decodeSegments(void);
+    void skipTo(cv::VideoCapture &reader, int64_t position, const int64_t frame);
+    bool decodeFrame(cv::VideoCapture &reader, const int64_t frame);
+
+    // Playback speed. When unthrottled, frames are published as quickly as
+    // the slowest SOURCE allows.
     double frame_rate_in_hz_;
+    bool unthrottled_ {false};
     void calculateFramePeriod(void);
 
-    // frame generation clock
-    std::chrono::high_resolution_clock clock_;
+    // Frame generation clock. Frame n is published at start_ + n * period so
+    // that timing error does not accumulate over long files.
+    using Clock = std::chrono::steady_clock;
     std::chrono::duration<double> frame_period_in_sec_;
-    std::chrono::high_resolution_clock::time_point tick_;
+    Clock::time_point start_, stop_;
+    void printThroughput(void);
 };
 
 }       /* namespace oat */
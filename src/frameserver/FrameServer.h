@@ -21,12 +21,19 @@
 #define	OAT_FRAMESERVER_H
 
 #include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
 #include <opencv2/opencv.hpp>
 
 #include "../../lib/datatypes/Frame.h"
+#include "../../lib/datatypes/Sample.h"
 #include "../../lib/shmemdf/Sink.h"
 #include "../../lib/shmemdf/SharedFrameHeader.h"
 
+#include "SampleGroup.h"
+
 namespace oat {
 
 /**
@@ -63,6 +70,24 @@ public:
     virtual void configure(void) = 0;
     virtual void configure(const std::string &file_name, const std::string &key) = 0;
 
+    /**
+     * Join a group of FrameServers running in the same process. Members of a
+     * group stamp their samples against a common time base and can be made
+     * to publish only complete sets of frames.
+     * @param group Group to join. Must be set before serving frames.
+     */
+    void joinGroup(const std::shared_ptr<oat::SampleGroup> &group) {
+        group_ = group;
+    }
+
+    /**
+     * Publish downscaled copies of each frame in addition to the full
+     * resolution frame. Level l is 1/2^l the size of the served frame in
+     * each dimension and is published to SINK_2^l (e.g. raw_2, raw_4).
+     * @param levels Number of pyramid levels.
+     */
+    void setPyramidLevels(const size_t levels) { pyramid_levels_ = levels; }
+
     // Accessors
     std::string name() const { return name_; }
 
@@ -82,6 +107,153 @@ protected:
     // Currently acquired, shared frame
     bool frame_empty_;
     oat::Frame shared_frame_;
+
+    /**
+     * Increment the sample count of the shared frame and tell SOURCEs there
+     * is new data. Ends the critical section in place of frame_sink_.post().
+     */
+    void postFrame(void) {
+
+        if (group_) {
+            group_->arrive();
+            shared_frame_.sample().incrementCount(group_->now());
+        } else {
+            shared_frame_.sample().incrementCount();
+        }
+
+        frame_sink_.post();
+        publishPyramid();
+    }
+
+    /**
+     * Increment the sample count of the shared frame and tell SOURCEs there
+     * is new data. Ends the critical section in place of frame_sink_.post().
+     * @param usec Device timestamp of the frame.
+     */
+    void postFrame(const oat::Sample::Microseconds usec) {
+
+        shared_frame_.sample().incrementCount(groupTime(usec));
+
+        frame_sink_.post();
+        publishPyramid();
+    }
+
+    /**
+     * Set the sample count of the shared frame and tell SOURCEs there is new
+     * data. Ends the critical section in place of frame_sink_.post().
+     * @param count Sample count the frame was recorded with.
+     * @param usec Recorded timestamp of the frame.
+     */
+    void postFrame(const uint64_t count, const oat::Sample::Microseconds usec) {
+
+        shared_frame_.sample().set_count(count, groupTime(usec));
+
+        frame_sink_.post();
+        publishPyramid();
+    }
+
+private:
+
+    // Server group, if any
+    std::shared_ptr<oat::SampleGroup> group_;
+    bool group_offset_set_ {false};
+    oat::Sample::Microseconds group_offset_ {0};
+
+    /**
+     * Arrive at the group, if any, and map a device timestamp to the group's
+     * time base.
+     * @param usec Device timestamp of the frame.
+     * @return Timestamp of the frame's sample.
+     */
+    oat::Sample::Microseconds groupTime(const oat::Sample::Microseconds usec) {
+
+        if (!group_)
+            return usec;
+
+        group_->arrive();
+
+        // Align the device clock to the group's time base on the first frame
+        if (!group_offset_set_) {
+            group_offset_ = group_->now() - usec;
+            group_offset_set_ = true;
+        }
+
+        return usec + group_offset_;
+    }
+
+    // Downscaled frame pyramid
+    struct PyramidLevel {
+        oat::Sink<oat::SharedFrameHeader> sink;
+        oat::Frame frame;
+    };
+    size_t pyramid_levels_ {0};
+    std::vector<std::unique_ptr<PyramidLevel>> pyramid_;
+
+    /**
+     * Publish each pyramid level, computed from the level above it. Called
+     * after the served frame has been posted, which SOURCEs only read until
+     * the next call to frame_sink_.wait().
+     */
+    void publishPyramid(void) {
+
+        if (pyramid_levels_ == 0)
+            return;
+
+        // Levels are bound once the served frame's geometry is known
+        if (pyramid_.empty()) {
+
+            int rows = shared_frame_.rows;
+            int cols = shared_frame_.cols;
+
+            // Each level's pixels are twice the size of those of the level
+            // above, and their centers are offset by half a pixel above
+            double scale = 1.0;
+            double offset = 0.0;
+
+            for (size_t l = 1; l <= pyramid_levels_; l++) {
+
+                rows /= 2;
+                cols /= 2;
+                if (rows == 0 || cols == 0)
+                    throw std::runtime_error("Frames are too small for "
+                            + std::to_string(pyramid_levels_)
+                            + " pyramid levels.");
+
+                offset += 0.5 * scale;
+                scale *= 2.0;
+
+                std::unique_ptr<PyramidLevel> level(new PyramidLevel);
+                level->sink.bind(frame_sink_address_ + "_"
+                                 + std::to_string(1 << l),
+                                 rows * cols * shared_frame_.elemSize());
+                level->frame = level->sink.retrieve(rows, cols,
+                                                    shared_frame_.type(),
+                                                    offset, offset, false,
+                                                    scale, scale);
+                level->frame.sample() = shared_frame_.sample();
+                pyramid_.push_back(std::move(level));
+            }
+        }
+
+        const oat::Frame *above = &shared_frame_;
+        for (auto &level : pyramid_) {
+
+            // Crop odd rows and columns so that the scale is exactly 2,
+            // which selects OpenCV's vectorized area-averaging path
+            const cv::Rect even(0, 0, 2 * level->frame.cols,
+                                2 * level->frame.rows);
+
+            level->sink.wait();
+
+            cv::resize(cv::Mat(*above, even), level->frame,
+                       level->frame.size(), 0, 0, cv::INTER_AREA);
+            level->frame.sample() = shared_frame_.sample();
+
+            level->sink.post();
+
+            above = &level->frame;
+        }
+    }
 };
 
 }       /* namespace oat */
@@ -0,0 +1,433 @@
+//******************************************************************************
+//* File:   ImageSequence.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <sys/stat.h>
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+#include <cpptoml.h>
+#include "../../lib/utility/OatTOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+
+#include "ImageSequence.h"
+
+namespace oat {
+
+namespace {
+
+// Extensions of the image files that are served from a directory
+const std::vector<std::string> image_extensions {
+    ".png", ".jpg", ".jpeg", ".bmp", ".tif", ".tiff",
+    ".pgm", ".ppm", ".pbm", ".pnm", ".webp", ".exr"};
+
+bool isImage(const std::string &file) {
+
+    const auto dot = file.find_last_of('.');
+    if (dot == std::string::npos)
+        return false;
+
+    std::string ext = file.substr(dot);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+
+    return std::find(image_extensions.begin(), image_extensions.end(), ext)
+           != image_extensions.end();
+}
+
+// Compare strings, treating runs of digits as numbers
+bool naturalLess(const std::string &a, const std::string &b) {
+
+    auto digit = [](const char c) {
+        return std::isdigit(static_cast<unsigned char>(c)) != 0;
+    };
+
+    size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size()) {
+
+        if (digit(a[i]) && digit(b[j])) {
+
+            // Skip leading zeros, then the longer run is larger
+            size_t i0 = i, j0 = j;
+            while (i0 < a.size() && a[i0] == '0') i0++;
+            while (j0 < b.size() && b[j0] == '0') j0++;
+
+            size_t i1 = i0, j1 = j0;
+            while (i1 < a.size() && digit(a[i1])) i1++;
+            while (j1 < b.size() && digit(b[j1])) j1++;
+
+            if (i1 - i0 != j1 - j0)
+                return i1 - i0 < j1 - j0;
+
+            const int c = a.compare(i0, i1 - i0, b, j0, j1 - j0);
+            if (c != 0)
+                return c < 0;
+
+            i = i1;
+            j = j1;
+
+        } else {
+
+            if (a[i] != b[j])
+                return a[i] < b[j];
+
+            i++;
+            j++;
+        }
+    }
+
+    return a.size() - i < b.size() - j;
+}
+
+} /* namespace */
+
+ImageSequence::ImageSequence(const std::string &frame_sink_address,
+                             const std::string &path,
+                             const double frames_per_second) :
+  FrameServer(frame_sink_address)
+, path_(path)
+, frame_rate_in_hz_(frames_per_second)
+{
+    // Default config
+    calculateFramePeriod();
+}
+
+ImageSequence::~ImageSequence() {
+
+    // Release any decode threads waiting on a free slot and join them
+    {
+        std::lock_guard<std::mutex> lk(decode_mutex_);
+        decoding_ = false;
+    }
+
+    slot_free_cv_.notify_all();
+
+    for (auto &t : decode_threads_)
+        t.join();
+}
+
+void ImageSequence::listFiles() {
+
+    struct stat st;
+    const bool is_dir = stat(path_.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+
+    std::vector<cv::String> matches;
+    cv::glob(is_dir ? path_ + "/*" : path_, matches, false);
+
+    for (const auto &m : matches) {
+        if (!is_dir || isImage(m))
+            files_.push_back(m);
+    }
+
+    if (files_.empty())
+        throw std::runtime_error("No images were found at " + path_ + ".");
+
+    std::sort(files_.begin(), files_.end(), naturalLess);
+}
+
+void ImageSequence::loadTimestamps() {
+
+    std::vector<double> raw;
+
+    if (!timestamp_file_.empty()) {
+
+        // One timestamp per line, in the same order as the images
+        std::ifstream in(timestamp_file_);
+        if (!in)
+            throw std::runtime_error(timestamp_file_ + " could not be opened.");
+
+        double t;
+        while (in >> t)
+            raw.push_back(t);
+
+        if (!in.eof())
+            throw std::runtime_error(timestamp_file_
+                                     + " contains a malformed timestamp.");
+
+        if (raw.size() != files_.size())
+            throw std::runtime_error(timestamp_file_ + " contains "
+                    + std::to_string(raw.size()) + " timestamps for "
+                    + std::to_string(files_.size()) + " images.");
+
+    } else if (!timestamp_regex_.empty()) {
+
+        // The first capture group of the file name is the timestamp
+        const std::regex re(timestamp_regex_);
+
+        for (const auto &f : files_) {
+
+            const std::string name = f.substr(f.find_last_of('/') + 1);
+            std::smatch match;
+            if (!std::regex_search(name, match, re) || match.size() < 2)
+                throw std::runtime_error("Timestamp could not be parsed from "
+                                         + name + ".");
+
+            raw.push_back(std::stod(match[1].str()));
+        }
+
+    } else {
+        return;
+    }
+
+    timestamps_.reserve(raw.size());
+    for (const auto &t : raw) {
+
+        const double sec = (t - raw.front()) * timestamp_scale_;
+        if (!timestamps_.empty() && sec < timestamps_.back())
+            throw std::runtime_error("Image timestamps must not decrease.");
+
+        timestamps_.push_back(sec);
+    }
+}
+
+void ImageSequence::connectToNode() {
+
+    listFiles();
+    loadTimestamps();
+
+    // The first image determines the frame geometry
+    cv::Mat example_frame = cv::imread(files_.front());
+    if (example_frame.empty())
+        throw std::runtime_error(files_.front() + " could not be opened.");
+
+    if (use_roi_)
+        example_frame = example_frame(region_of_interest_);
+
+    frame_sink_.bind(frame_sink_address_,
+            example_frame.total() * example_frame.elemSize());
+
+    shared_frame_ = frame_sink_.retrieve(
+            example_frame.rows, example_frame.cols, example_frame.type());
+
+    // Put the sample rate in the shared frame
+    if (timestamps_.size() > 1)
+        shared_frame_.sample().set_period_sec(
+            timestamps_.back() / (timestamps_.size() - 1));
+    else
+        shared_frame_.sample().set_period_sec(frame_period_in_sec_.count());
+
+    // Start decoding ahead of the serving loop
+    decode_slots_.resize(prefetch_depth_);
+    slot_image_.assign(prefetch_depth_, -1);
+    decoding_ = true;
+
+    for (int64_t i = 0; i < num_decode_threads_; i++)
+        decode_threads_.emplace_back(&ImageSequence::decodeImages, this);
+}
+
+void ImageSequence::decodeImages() {
+
+    const int64_t window = static_cast<int64_t>(decode_slots_.size());
+    const int64_t num_images = static_cast<int64_t>(files_.size());
+
+    // Images are claimed in order, so the thread holding the oldest
+    // outstanding image always has a free slot and cannot deadlock
+    for (int64_t image = next_claim_++; image < num_images;
+         image = next_claim_++) {
+
+        const size_t slot = image % window;
+
+        // Wait until the previous occupant of this slot has been published
+        {
+            std::unique_lock<std::mutex> lk(decode_mutex_);
+            slot_free_cv_.wait(lk, [this, image, window] {
+                return !decoding_ || image < next_image_ + window;
+            });
+
+            if (!decoding_)
+                return;
+        }
+
+        // Decode into the free slot without holding the lock. Failures are
+        // left empty and reported when the image is due to be served.
+        decode_slots_[slot] = cv::imread(files_[image]);
+
+        {
+            std::lock_guard<std::mutex> lk(decode_mutex_);
+            slot_image_[slot] = image;
+        }
+
+        image_ready_cv_.notify_all();
+    }
+}
+
+bool ImageSequence::serveFrame() {
+
+    frame_empty_ = next_image_ >= static_cast<int64_t>(files_.size());
+    if (frame_empty_)
+        return true;
+
+    const size_t slot = next_image_ % decode_slots_.size();
+
+    // Wait for the next image in sequence to be decoded. This occurs outside
+    // the critical section so that decode time is not imposed on SOURCEs.
+    {
+        std::unique_lock<std::mutex> lk(decode_mutex_);
+        image_ready_cv_.wait(lk, [this, slot] {
+            return slot_image_[slot] == next_image_;
+        });
+    }
+
+    const cv::Mat &frame = decode_slots_[slot];
+
+    if (frame.empty())
+        throw std::runtime_error(files_[next_image_] + " could not be decoded.");
+
+    if (frame.type() != shared_frame_.type()
+        || (!use_roi_ && frame.size() != shared_frame_.size()))
+        throw std::runtime_error(files_[next_image_] + " does not match the "
+                                 "size and type of the first image.");
+
+    if (next_image_ == 0)
+        start_ = Clock::now();
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sources to read
+    frame_sink_.wait();
+
+    // Publish the decoded image, cropping if necessary
+    if (!use_roi_)
+        frame.copyTo(shared_frame_);
+    else
+        frame(region_of_interest_).copyTo(shared_frame_);
+
+    // Increment sample count and tell sources there is new data
+    if (timestamps_.empty())
+        postFrame();
+    else
+        postFrame(std::chrono::duration_cast<oat::Sample::Microseconds>(
+            std::chrono::duration<double>(timestamps_[next_image_])));
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    // Release the slot to the decode threads
+    {
+        std::lock_guard<std::mutex> lk(decode_mutex_);
+        slot_image_[slot] = -1;
+        next_image_++;
+    }
+
+    slot_free_cv_.notify_all();
+
+    // Publish the next image at its timestamp, or at the frame rate,
+    // against an absolute deadline
+    if (!unthrottled_ && next_image_ < static_cast<int64_t>(files_.size())) {
+
+        const std::chrono::duration<double> due = timestamps_.empty()
+            ? frame_period_in_sec_ * next_image_
+            : std::chrono::duration<double>(timestamps_[next_image_]);
+
+        std::this_thread::sleep_until(start_ +
+            std::chrono::duration_cast<Clock::duration>(due));
+    }
+
+    return false;
+}
+
+void ImageSequence::configure() { }
+
+void ImageSequence::configure(const std::string& config_file,
+                              const std::string& config_key) {
+
+    // Available options
+    std::vector<std::string> options {"fps",
+                                      "unthrottled",
+                                      "roi",
+                                      "prefetch",
+                                      "decode_threads",
+                                      "timestamp_file",
+                                      "timestamp_regex",
+                                      "timestamp_scale"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    auto config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config->contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config->get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        // Set the frame rate
+        oat::config::getValue(this_config, "fps", frame_rate_in_hz_, 0.0);
+        calculateFramePeriod();
+
+        // Ignore the frame rate and publish as quickly as SOURCEs allow
+        oat::config::getValue(this_config, "unthrottled", unthrottled_);
+
+        // Parallel decoding
+        oat::config::getValue(this_config, "decode_threads",
+                              num_decode_threads_, (int64_t)1);
+        oat::config::getValue(this_config, "prefetch",
+                              prefetch_depth_, (int64_t)1);
+
+        // Sample times
+        oat::config::getValue(this_config, "timestamp_file", timestamp_file_);
+        oat::config::getValue(this_config, "timestamp_regex", timestamp_regex_);
+        oat::config::getValue(this_config, "timestamp_scale", timestamp_scale_, 0.0);
+
+        if (!timestamp_file_.empty() && !timestamp_regex_.empty())
+            throw std::runtime_error("Only one of 'timestamp_file' and "
+                                     "'timestamp_regex' can be specified.");
+
+        // Set the ROI
+        oat::config::Table roi;
+        if (oat::config::getTable(this_config, "roi", roi)) {
+
+            int64_t val;
+            oat::config::getValue(roi, "x_offset", val, (int64_t)0, true);
+            region_of_interest_.x = val;
+            oat::config::getValue(roi, "y_offset", val, (int64_t)0, true);
+            region_of_interest_.y = val;
+            oat::config::getValue(roi, "width", val, (int64_t)0, true);
+            region_of_interest_.width = val;
+            oat::config::getValue(roi, "height", val, (int64_t)0, true);
+            region_of_interest_.height = val;
+            use_roi_ = true;
+        }
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+void ImageSequence::calculateFramePeriod() {
+
+    std::chrono::duration<double> frame_period {1.0 / frame_rate_in_hz_};
+
+    // Automatic conversion
+    frame_period_in_sec_ = frame_period;
+}
+
+} /* namespace oat */
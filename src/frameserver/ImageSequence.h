@@ -0,0 +1,111 @@
+//******************************************************************************
+//* File:   ImageSequence.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+
+#ifndef OAT_IMAGESEQUENCE_H
+#define	OAT_IMAGESEQUENCE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "FrameServer.h"
+
+namespace oat {
+
+/**
+ * Serves a sequence of image files, e.g. PNG or JPEG frames dumped by a
+ * camera, in natural sort order (frame_2.png precedes frame_10.png). Images
+ * are decoded in parallel ahead of the serving loop and published strictly
+ * in order. Sample times can be taken from a sidecar file or parsed from the
+ * file names.
+ */
+class ImageSequence : public FrameServer {
+public:
+
+    /**
+     * @param frame_sink_address Address of node to publish shared frames to.
+     * @param path Directory containing the images or a glob pattern
+     * matching them (e.g. "dir/frame_*.png").
+     * @param frames_per_second Publication rate when timestamps are not
+     * provided.
+     */
+    ImageSequence(const std::string &frame_sink_address,
+                  const std::string &path,
+                  const double frames_per_second = 30);
+
+    ~ImageSequence();
+
+    // Implement FrameServer interface
+    void configure(void) override;
+    void configure(const std::string &config_file,
+                   const std::string &config_key) override;
+    void connectToNode(void) override;
+    bool serveFrame(void) override;
+
+private:
+
+    // Image files, in publication order
+    std::string path_;
+    std::vector<std::string> files_;
+    void listFiles(void);
+
+    // Sample times, in seconds, relative to the first image. Empty if frames
+    // are timed using the frame rate.
+    std::string timestamp_file_;
+    std::string timestamp_regex_;
+    double timestamp_scale_ {1.0};
+    std::vector<double> timestamps_;
+    void loadTimestamps(void);
+
+    // Decode pool. Image n is decoded into slot n % prefetch_depth_ by
+    // whichever thread claims it, so decoding can run at most
+    // prefetch_depth_ images ahead of publication.
+    int64_t prefetch_depth_ {16};
+    int64_t num_decode_threads_ {2};
+    std::vector<cv::Mat> decode_slots_;
+    std::vector<int64_t> slot_image_;
+    int64_t next_image_ {0};
+    std::atomic<int64_t> next_claim_ {0};
+    bool decoding_ {false};
+    std::vector<std::thread> decode_threads_;
+    std::mutex decode_mutex_;
+    std::condition_variable image_ready_cv_;
+    std::condition_variable slot_free_cv_;
+    void decodeImages(void);
+
+    // Playback speed. When unthrottled, frames are published as quickly as
+    // the slowest SOURCE allows.
+    double frame_rate_in_hz_;
+    bool unthrottled_ {false};
+    void calculateFramePeriod(void);
+
+    // Image n is published at start_ + timestamps_[n], or start_ + n * period
+    using Clock = std::chrono::steady_clock;
+    std::chrono::duration<double> frame_period_in_sec_;
+    Clock::time_point start_;
+};
+
+}       /* namespace oat */
+#endif	/* OAT_IMAGESEQUENCE_H */
@@ -0,0 +1,266 @@
+//******************************************************************************
+//* File:   MultiServer.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+
+#include "OatConfig.h" // Generated by CMake
+
+#include <chrono>
+#include <csignal>
+#include <stdexcept>
+#include <string>
+#include <pthread.h>
+#include <boost/interprocess/exceptions.hpp>
+
+#include <cpptoml.h>
+#include "../../lib/utility/OatTOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+
+#include "TestFrame.h"
+#include "SyntheticFrame.h"
+#include "FileReader.h"
+#include "RawFileReader.h"
+#include "ImageSequence.h"
+#include "WebCam.h"
+#ifdef USE_FLYCAP
+    #include "PGGigECam.h"
+#endif
+#ifdef USE_V4L2
+    #include "V4L2Cam.h"
+#endif
+
+#include "MultiServer.h"
+
+namespace oat {
+
+MultiServer::MultiServer(const std::string &frame_sink_address) :
+  FrameServer(frame_sink_address)
+{
+    // Nothing
+}
+
+MultiServer::~MultiServer() {
+
+    // Release members waiting on the group and let each finish its current
+    // frame
+    running_ = false;
+    if (sample_group_)
+        sample_group_->cancel();
+
+    for (auto &t : member_threads_)
+        t.join();
+}
+
+void MultiServer::configure() {
+
+    throw std::runtime_error("TYPE=multi requires a configuration file "
+                             "specifying its members.");
+}
+
+void MultiServer::configure(const std::string &config_file,
+                            const std::string &config_key) {
+
+    // Available options
+    std::vector<std::string> options {"wait_for_set", "members"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    auto config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config->contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config->get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        // Publish complete frame sets only
+        oat::config::getValue(this_config, "wait_for_set", wait_for_set_);
+
+        // Each key in the members table names a member server
+        oat::config::Table members;
+        if (!oat::config::getTable(this_config, "members", members))
+            throw std::runtime_error("TYPE=multi requires a 'members' table.");
+
+        for (auto it = members->begin(); it != members->end(); it++) {
+
+            oat::config::Table member_config;
+            oat::config::getTable(members, it->first, member_config);
+            oat::config::checkKeys(
+                {"type", "sink", "config", "file", "index", "fps", "pyramid"},
+                member_config);
+
+            std::string type;
+            oat::config::getValue(member_config, "type", type, true);
+
+            // Default sink is derived from the group sink and member name
+            std::string sink = frame_sink_address_ + "_" + it->first;
+            oat::config::getValue(member_config, "sink", sink);
+
+            std::string file;
+            oat::config::getValue(member_config, "file", file);
+
+            int64_t index = 0;
+            oat::config::getValue(member_config, "index", index, (int64_t)0);
+
+            // Raw files are paced at their recorded sample period unless a
+            // frame rate is given
+            double fps = 30;
+            if (!oat::config::getValue(member_config, "fps", fps, 0.0)
+                && type == "raw")
+                fps = 0.0;
+
+            auto member = makeMember(type, sink, file, index, fps);
+
+            // Members are configured from their own top-level table
+            std::string member_key;
+            if (oat::config::getValue(member_config, "config", member_key))
+                member->configure(config_file, member_key);
+            else
+                member->configure();
+
+            int64_t pyramid_levels = 0;
+            oat::config::getValue(member_config, "pyramid", pyramid_levels,
+                                  (int64_t)0);
+            member->setPyramidLevels(pyramid_levels);
+
+            members_.push_back(member);
+        }
+
+        if (members_.empty())
+            throw std::runtime_error("TYPE=multi requires at least one member.");
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+std::shared_ptr<oat::FrameServer>
+MultiServer::makeMember(const std::string &type,
+                        const std::string &sink,
+                        const std::string &file,
+                        const size_t index,
+                        const double fps) {
+
+    if ((type == "file" || type == "test" || type == "raw" || type == "seq")
+        && file.empty())
+        throw std::runtime_error("Member " + oat::sinkText(sink) + " of type "
+                                 + type + " requires a 'file'.");
+
+    if (type == "wcam") {
+        return std::make_shared<oat::WebCam>(sink);
+    } else if (type == "gige") {
+#ifdef USE_FLYCAP
+        return std::make_shared<oat::PGGigECam>(sink, index, fps);
+#else
+        throw std::runtime_error("Oat was not compiled with Point-Grey "
+                                 "flycapture support, so member TYPE=gige "
+                                 "is not available.");
+#endif
+    } else if (type == "v4l2") {
+#ifdef USE_V4L2
+        return std::make_shared<oat::V4L2Cam>(sink, index);
+#else
+        throw std::runtime_error("Oat was not compiled with Video4Linux2 "
+                                 "support, so member TYPE=v4l2 is not "
+                                 "available.");
+#endif
+    } else if (type == "file") {
+        return std::make_shared<oat::FileReader>(sink, file, fps);
+    } else if (type == "raw") {
+        return std::make_shared<oat::RawFileReader>(sink, file, fps);
+    } else if (type == "seq") {
+        return std::make_shared<oat::ImageSequence>(sink, file, fps);
+    } else if (type == "test") {
+        return std::make_shared<oat::TestFrame>(sink, file);
+    } else if (type == "synth") {
+        return std::make_shared<oat::SyntheticFrame>(sink, fps);
+    }
+
+    throw std::runtime_error("Invalid member TYPE '" + type + "'.");
+}
+
+void MultiServer::connectToNode() {
+
+    sample_group_ = std::make_shared<oat::SampleGroup>(members_.size(),
+                                                       wait_for_set_);
+
+    for (auto &m : members_) {
+        m->joinGroup(sample_group_);
+        m->connectToNode();
+    }
+
+    // SIGINT is left to the main thread, which tears members down
+    sigset_t sigint, old_mask;
+    sigemptyset(&sigint);
+    sigaddset(&sigint, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &sigint, &old_mask);
+
+    for (auto &m : members_)
+        member_threads_.emplace_back(&MultiServer::serveMember, this, m);
+
+    pthread_sigmask(SIG_SETMASK, &old_mask, nullptr);
+}
+
+bool MultiServer::serveFrame() {
+
+    std::unique_lock<std::mutex> lk(done_mutex_);
+    done_cv_.wait_for(lk, std::chrono::milliseconds(100));
+
+    if (member_error_)
+        std::rethrow_exception(member_error_);
+
+    // All member streams are exhausted
+    return members_done_ == members_.size();
+}
+
+void MultiServer::serveMember(std::shared_ptr<oat::FrameServer> member) {
+
+    try {
+
+        while (running_ && !member->serveFrame()) { }
+
+    } catch (const boost::interprocess::interprocess_exception &ex) {
+
+        // Error code 1 indicates an interrupted wait(), which is normal
+        // behavior
+        if (ex.get_error_code() != 1) {
+            std::lock_guard<std::mutex> lk(done_mutex_);
+            member_error_ = std::current_exception();
+        }
+
+    } catch (...) {
+
+        std::lock_guard<std::mutex> lk(done_mutex_);
+        member_error_ = std::current_exception();
+    }
+
+    // Remaining members stop waiting for this one
+    sample_group_->leave();
+
+    {
+        std::lock_guard<std::mutex> lk(done_mutex_);
+        members_done_++;
+    }
+
+    done_cv_.notify_all();
+}
+
+} /* namespace oat */
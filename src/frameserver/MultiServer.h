@@ -0,0 +1,85 @@
+//******************************************************************************
+//* File:   MultiServer.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+
+#ifndef OAT_MULTISERVER_H
+#define	OAT_MULTISERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FrameServer.h"
+#include "SampleGroup.h"
+
+namespace oat {
+
+/**
+ * Runs several FrameServers in one process, each publishing to its own SINK
+ * from its own thread. Members stamp their samples against a common time
+ * base and can be made to publish only complete sets of frames so that the
+ * Nth sample of every SINK was captured together.
+ */
+class MultiServer : public FrameServer {
+public:
+
+    MultiServer(const std::string &frame_sink_address);
+
+    ~MultiServer();
+
+    // Implement FrameServer interface
+    void configure(void) override;
+    void configure(const std::string &config_file,
+                   const std::string &config_key) override;
+    void connectToNode(void) override;
+    bool serveFrame(void) override;
+
+private:
+
+    // Member servers, constructed during configuration
+    std::vector<std::shared_ptr<oat::FrameServer>> members_;
+    std::shared_ptr<oat::FrameServer> makeMember(const std::string &type,
+                                                 const std::string &sink,
+                                                 const std::string &file,
+                                                 const size_t index,
+                                                 const double fps);
+
+    // If true, members publish complete frame sets only
+    bool wait_for_set_ {false};
+    std::shared_ptr<oat::SampleGroup> sample_group_;
+
+    // Member threads
+    std::vector<std::thread> member_threads_;
+    std::atomic<bool> running_ {true};
+    void serveMember(std::shared_ptr<oat::FrameServer> member);
+
+    // Member completion and errors
+    std::mutex done_mutex_;
+    std::condition_variable done_cv_;
+    size_t members_done_ {0};
+    std::exception_ptr member_error_;
+};
+
+}       /* namespace oat */
+#endif	/* OAT_MULTISERVER_H */
@@ -1030,10 +1030,9 @@ bool PGGigECam::serveFrame() {
         frame_sink_.wait();
 
         raw_image_.Convert(pg::PIXEL_FORMAT_BGR, rgb_image_.get());
-        shared_frame_.sample().incrementCount(tick_);
 
-        // Tell sources there is new data
-        frame_sink_.post();
+        // Increment sample count and tell sources there is new data
+        postFrame(tick_);
 
         ////////////////////////////
         //  END CRITICAL SECTION  //
@@ -0,0 +1,254 @@
+//******************************************************************************
+//* File:   RawFileReader.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <opencv2/core/mat.hpp>
+
+#include <cpptoml.h>
+#include "../../lib/utility/OatTOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+
+#include "RawFileReader.h"
+
+namespace oat {
+
+RawFileReader::RawFileReader(const std::string &frame_sink_address,
+                             const std::string &file_name,
+                             const double frames_per_second) :
+  FrameServer(frame_sink_address)
+, file_name_(file_name)
+, frame_rate_in_hz_(frames_per_second)
+{
+    // Default config
+    calculateFramePeriod();
+}
+
+RawFileReader::~RawFileReader() {
+
+    if (map_ != nullptr)
+        munmap(const_cast<uint8_t *>(map_), map_bytes_);
+
+    if (fd_ != -1)
+        close(fd_);
+}
+
+void RawFileReader::openFile() {
+
+    fd_ = open(file_name_.c_str(), O_RDONLY);
+    if (fd_ == -1)
+        throw std::runtime_error(file_name_ + " could not be opened: "
+                                 + std::strerror(errno));
+
+    struct stat st;
+    if (fstat(fd_, &st) == -1)
+        throw std::runtime_error(file_name_ + " could not be read: "
+                                 + std::strerror(errno));
+
+    map_bytes_ = st.st_size;
+    if (map_bytes_ < sizeof(oat::raw::FileHeader))
+        throw std::runtime_error(file_name_ + " is not a raw frame file.");
+
+    void *map = mmap(nullptr, map_bytes_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (map == MAP_FAILED)
+        throw std::runtime_error(file_name_ + " could not be mapped: "
+                                 + std::strerror(errno));
+    map_ = static_cast<const uint8_t *>(map);
+
+    // Frames are read once, in order
+    madvise(map, map_bytes_, MADV_SEQUENTIAL);
+
+    std::memcpy(&header_, map_, sizeof(header_));
+
+    if (std::memcmp(header_.magic, oat::raw::MAGIC, sizeof(header_.magic)) != 0)
+        throw std::runtime_error(file_name_ + " is not a raw frame file.");
+
+    if (header_.version != oat::raw::VERSION)
+        throw std::runtime_error(file_name_ + " has unsupported raw frame file "
+                                 "version " + std::to_string(header_.version) + ".");
+
+    const uint64_t frame_bytes = static_cast<uint64_t>(header_.rows)
+                                 * header_.cols * CV_ELEM_SIZE(header_.type);
+    if (header_.frame_bytes != frame_bytes
+        || header_.record_bytes < oat::raw::recordBytes(header_.frame_bytes)
+        || header_.header_bytes < sizeof(oat::raw::FileHeader)
+        || header_.header_bytes > map_bytes_)
+        throw std::runtime_error(file_name_ + " has an inconsistent header.");
+
+    // A partially written trailing record is ignored
+    num_frames_ = (map_bytes_ - header_.header_bytes) / header_.record_bytes;
+}
+
+void RawFileReader::connectToNode() {
+
+    openFile();
+
+    int rows = use_roi_ ? region_of_interest_.height : header_.rows;
+    int cols = use_roi_ ? region_of_interest_.width : header_.cols;
+
+    frame_sink_.bind(frame_sink_address_, rows * cols * CV_ELEM_SIZE(header_.type));
+    shared_frame_ = frame_sink_.retrieve(rows, cols, header_.type);
+
+    // Frames are paced at the recorded sample period unless a frame rate
+    // was given
+    if (frame_rate_in_hz_ <= 0) {
+        if (header_.period_sec > 0) {
+            frame_period_in_sec_ = std::chrono::duration<double>(header_.period_sec);
+        } else if (!unthrottled_) {
+            std::cerr << oat::whoWarn(name_,
+                "No sample period was recorded and no frame rate was given. "
+                "Frames will be published as quickly as SOURCEs allow.\n");
+            unthrottled_ = true;
+        }
+    }
+
+    // Put the recorded sample rate in the shared frame
+    if (header_.period_sec > 0)
+        shared_frame_.sample().set_period_sec(header_.period_sec);
+    else if (frame_rate_in_hz_ > 0)
+        shared_frame_.sample().set_period_sec(frame_period_in_sec_.count());
+}
+
+bool RawFileReader::serveFrame() {
+
+    frame_empty_ = next_frame_ >= num_frames_;
+    if (frame_empty_)
+        return true;
+
+    const uint8_t *record = map_ + header_.header_bytes
+                            + next_frame_ * header_.record_bytes;
+
+    oat::raw::FrameRecord meta;
+    std::memcpy(&meta, record, sizeof(meta));
+
+    // Wraps mapped pixel data without copying
+    const cv::Mat frame(header_.rows, header_.cols, header_.type,
+        const_cast<uint8_t *>(record + sizeof(oat::raw::FrameRecord)));
+
+    if (next_frame_ == 0) {
+        start_ = Clock::now();
+        first_count_ = meta.count;
+    }
+
+    // Enforce the correct frame rate against an absolute deadline
+    if (!unthrottled_ && meta.count > first_count_) {
+        std::this_thread::sleep_until(start_ +
+            std::chrono::duration_cast<Clock::duration>(
+                frame_period_in_sec_ * static_cast<double>(meta.count - first_count_)));
+    }
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sources to read
+    frame_sink_.wait();
+
+    // Copy straight from the mapping, cropping if necessary
+    if (!use_roi_)
+        frame.copyTo(shared_frame_);
+    else
+        frame(region_of_interest_).copyTo(shared_frame_);
+
+    // Carry over the samples dropped during recording
+    const uint64_t dropped = shared_frame_.sample().dropped();
+    if (meta.dropped > dropped)
+        shared_frame_.sample().incrementDropped(meta.dropped - dropped);
+
+    // Set the recorded sample count and time, and tell sources there is new
+    // data
+    postFrame(meta.count, oat::Sample::Microseconds(meta.microseconds));
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    next_frame_++;
+
+    return frame_empty_;
+}
+
+void RawFileReader::configure() { }
+
+void RawFileReader::configure(const std::string& config_file,
+                              const std::string& config_key) {
+
+    // Available options
+    std::vector<std::string> options {"fps", "unthrottled", "roi"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    auto config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config->contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config->get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        // Override the recorded sample period
+        oat::config::getValue(this_config, "fps", frame_rate_in_hz_, 0.0);
+        calculateFramePeriod();
+
+        // Ignore the frame rate and publish as quickly as SOURCEs allow
+        oat::config::getValue(this_config, "unthrottled", unthrottled_);
+
+        // Set the ROI
+        oat::config::Table roi;
+        if (oat::config::getTable(this_config, "roi", roi)) {
+
+            int64_t val;
+            oat::config::getValue(roi, "x_offset", val, (int64_t)0, true);
+            region_of_interest_.x = val;
+            oat::config::getValue(roi, "y_offset", val, (int64_t)0, true);
+            region_of_interest_.y = val;
+            oat::config::getValue(roi, "width", val, (int64_t)0, true);
+            region_of_interest_.width = val;
+            oat::config::getValue(roi, "height", val, (int64_t)0, true);
+            region_of_interest_.height = val;
+            use_roi_ = true;
+        }
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+void RawFileReader::calculateFramePeriod() {
+
+    if (frame_rate_in_hz_ <= 0)
+        return;
+
+    std::chrono::duration<double> frame_period {1.0 / frame_rate_in_hz_};
+
+    // Automatic conversion
+    frame_period_in_sec_ = frame_period;
+}
+
+} /* namespace oat */
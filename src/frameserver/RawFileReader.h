@@ -0,0 +1,85 @@
+//******************************************************************************
+//* File:   RawFileReader.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_RAWFILEREADER_H
+#define	OAT_RAWFILEREADER_H
+
+#include <chrono>
+#include <string>
+
+#include "../../lib/utility/RawFrameFormat.h"
+
+#include "FrameServer.h"
+
+namespace oat {
+
+/**
+ * Serves frames from a raw frame container (see RawFrameFormat.h), such as
+ * those written by the recorder. The file is memory mapped and read
+ * sequentially, so no decoding is required.
+ */
+class RawFileReader : public FrameServer {
+public:
+
+    /**
+     * @param frames_per_second Playback rate. If 0, frames are paced at the
+     * sample period they were recorded with.
+     */
+    RawFileReader(const std::string &frame_sink_address,
+                  const std::string &file_name,
+                  const double frames_per_second = 0.0);
+
+    ~RawFileReader();
+
+    // Implement FrameServer interface
+    void configure(void) override;
+    void configure(const std::string &config_file,
+                   const std::string &config_key) override;
+    void connectToNode(void) override;
+    bool serveFrame(void) override;
+
+private:
+
+    // Mapped file
+    std::string file_name_;
+    int fd_ {-1};
+    const uint8_t *map_ {nullptr};
+    size_t map_bytes_ {0};
+    oat::raw::FileHeader header_;
+    uint64_t num_frames_ {0};
+    uint64_t next_frame_ {0};
+    void openFile(void);
+
+    // Playback speed, overriding the recorded sample period if > 0. When
+    // unthrottled, frames are published as quickly as the slowest SOURCE
+    // allows.
+    double frame_rate_in_hz_;
+    bool unthrottled_ {false};
+    void calculateFramePeriod(void);
+
+    // A frame is published at start_ + (count - first_count_) * period, so
+    // that samples dropped during recording keep their place in time
+    using Clock = std::chrono::steady_clock;
+    std::chrono::duration<double> frame_period_in_sec_ {0.0};
+    Clock::time_point start_;
+    uint64_t first_count_ {0};
+};
+
+}       /* namespace oat */
+#endif	/* OAT_RAWFILEREADER_H */
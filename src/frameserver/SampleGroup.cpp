@@ -0,0 +1,89 @@
+//******************************************************************************
+//* File:   SampleGroup.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "SampleGroup.h"
+
+namespace oat {
+
+SampleGroup::SampleGroup(const size_t size, const bool wait_for_set) :
+  start_(Clock::now())
+, wait_for_set_(wait_for_set)
+, size_(size)
+{
+    // Nothing
+}
+
+oat::Sample::Microseconds SampleGroup::now() const {
+
+    return std::chrono::duration_cast<oat::Sample::Microseconds>(
+            Clock::now() - start_);
+}
+
+void SampleGroup::arrive() {
+
+    if (!wait_for_set_)
+        return;
+
+    std::unique_lock<std::mutex> lk(mutex_);
+
+    if (cancelled_)
+        return;
+
+    const uint64_t generation = generation_;
+
+    if (++arrived_ >= size_) {
+        completeSet();
+        return;
+    }
+
+    set_cv_.wait(lk, [this, generation] {
+        return generation_ != generation || cancelled_;
+    });
+}
+
+void SampleGroup::leave() {
+
+    std::lock_guard<std::mutex> lk(mutex_);
+
+    if (size_ > 0)
+        size_--;
+
+    // The departing member may have been the last one outstanding
+    if (arrived_ > 0 && arrived_ >= size_)
+        completeSet();
+}
+
+void SampleGroup::cancel() {
+
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        cancelled_ = true;
+    }
+
+    set_cv_.notify_all();
+}
+
+void SampleGroup::completeSet() {
+
+    arrived_ = 0;
+    generation_++;
+    set_cv_.notify_all();
+}
+
+} /* namespace oat */
@@ -0,0 +1,90 @@
+//******************************************************************************
+//* File:   SampleGroup.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_SAMPLEGROUP_H
+#define	OAT_SAMPLEGROUP_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+#include "../../lib/datatypes/Sample.h"
+
+namespace oat {
+
+/**
+ * Synchronization point for FrameServers that run on separate threads of the
+ * same process. Members share a time base, and when complete sets are
+ * required, no member publishes its Nth frame until all members have their
+ * Nth frame ready. Members therefore also share sample numbers.
+ */
+class SampleGroup {
+public:
+
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @param size Number of members.
+     * @param wait_for_set If true, members publish complete frame sets only.
+     */
+    SampleGroup(const size_t size, const bool wait_for_set);
+
+    /**
+     * Time since the group's common time base.
+     * @return Elapsed microseconds.
+     */
+    oat::Sample::Microseconds now(void) const;
+
+    /**
+     * Called by a member when its frame is ready to be published. If complete
+     * sets are required, blocks until every member has called arrive() or the
+     * group has been cancelled.
+     */
+    void arrive(void);
+
+    /**
+     * Called by a member that will not publish any more frames, so that the
+     * remaining members do not wait for it.
+     */
+    void leave(void);
+
+    /**
+     * Release all waiting members and stop waiting for complete sets.
+     */
+    void cancel(void);
+
+private:
+
+    const Clock::time_point start_;
+    const bool wait_for_set_;
+
+    std::mutex mutex_;
+    std::condition_variable set_cv_;
+    size_t size_;
+    size_t arrived_ {0};
+    uint64_t generation_ {0};
+    bool cancelled_ {false};
+
+    // Must be called with mutex_ held
+    void completeSet(void);
+};
+
+}       /* namespace oat */
+#endif	/* OAT_SAMPLEGROUP_H */
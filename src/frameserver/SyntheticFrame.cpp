@@ -0,0 +1,297 @@
+//******************************************************************************
+//* File:   SyntheticFrame.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <opencv2/imgproc.hpp>
+
+#include <cpptoml.h>
+#include "../../lib/utility/OatTOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+#include "../../lib/utility/make_unique.h"
+
+#include "SyntheticFrame.h"
+
+namespace oat {
+
+// Drawing is performed with 4 fractional bits so that rendered blob centers
+// match the ground truth position to within 1/16 pixel
+static constexpr int DRAW_SHIFT {4};
+
+SyntheticFrame::SyntheticFrame(const std::string &frame_sink_address,
+                               const double frames_per_second) :
+  FrameServer(frame_sink_address)
+, frame_rate_in_hz_(frames_per_second)
+{
+    calculateFramePeriod();
+}
+
+void SyntheticFrame::configure() {
+
+    // A single white blob without a ground truth SINK
+    blobs_.push_back(std::make_unique<Blob>("blob"));
+}
+
+void SyntheticFrame::configure(const std::string &config_file,
+                               const std::string &config_key) {
+
+    // Available options
+    std::vector<std::string> options {"width",
+                                      "height",
+                                      "fps",
+                                      "unthrottled",
+                                      "background",
+                                      "accel_sd",
+                                      "seed",
+                                      "blobs"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    auto config = cpptoml::parse_file(config_file);
+
+    // See if a configuration was provided
+    if (config->contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config->get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        // Frame geometry
+        oat::config::getValue(this_config, "width", width_, (int64_t)1);
+        oat::config::getValue(this_config, "height", height_, (int64_t)1);
+
+        // Frame rate
+        oat::config::getValue(this_config, "fps", frame_rate_in_hz_, 0.0);
+        calculateFramePeriod();
+
+        // Ignore the frame rate and publish as quickly as SOURCEs allow
+        oat::config::getValue(this_config, "unthrottled", unthrottled_);
+
+        // Background color
+        oat::config::Array bg_array;
+        if (oat::config::getArray(this_config, "background", bg_array, 3)) {
+            auto bg = bg_array->array_of<int64_t>();
+            background_ = cv::Scalar(bg[0]->get(), bg[1]->get(), bg[2]->get());
+        }
+
+        // Standard deviation of random accelerations (pixels/sec^2)
+        double accel_sd;
+        if (oat::config::getValue(this_config, "accel_sd", accel_sd, 0.0))
+            accel_distribution_ = std::normal_distribution<double>(0.0, accel_sd);
+
+        // Fixed seed for reproducible motion
+        int64_t seed;
+        if (oat::config::getValue(this_config, "seed", seed))
+            accel_generator_.seed(seed);
+
+        // Each key in the blobs table names a blob
+        oat::config::Table blobs;
+        if (oat::config::getTable(this_config, "blobs", blobs)) {
+
+            for (auto it = blobs->begin(); it != blobs->end(); it++) {
+
+                oat::config::Table blob_config;
+                oat::config::getTable(blobs, it->first, blob_config);
+                oat::config::checkKeys({"color", "radius", "sink"}, blob_config);
+
+                auto blob = std::make_unique<Blob>(it->first);
+
+                oat::config::Array color_array;
+                if (oat::config::getArray(blob_config, "color", color_array, 3)) {
+                    auto c = color_array->array_of<int64_t>();
+                    blob->color = cv::Scalar(c[0]->get(), c[1]->get(), c[2]->get());
+                }
+
+                int64_t radius;
+                if (oat::config::getValue(blob_config, "radius", radius, (int64_t)1))
+                    blob->radius = radius;
+
+                oat::config::getValue(blob_config, "sink", blob->sink_address);
+
+                blobs_.push_back(std::move(blob));
+            }
+        }
+
+        if (blobs_.empty())
+            configure();
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+void SyntheticFrame::connectToNode() {
+
+    if (blobs_.empty())
+        configure();
+
+    frame_sink_.bind(frame_sink_address_, width_ * height_ * 3);
+    shared_frame_ = frame_sink_.retrieve(height_, width_, CV_8UC3);
+    shared_frame_.setTo(background_);
+
+    // Put the sample rate in the shared frame
+    shared_frame_.sample().set_period_sec(frame_period_in_sec_.count());
+
+    std::uniform_real_distribution<double> x_dist(0, width_);
+    std::uniform_real_distribution<double> y_dist(0, height_);
+
+    for (auto &b : blobs_) {
+
+        // Start each blob at rest somewhere in the frame
+        b->state(0) = x_dist(accel_generator_);
+        b->state(2) = y_dist(accel_generator_);
+
+        b->truth.position_valid = true;
+        b->truth.velocity_valid = true;
+        b->truth.sample().set_period_sec(frame_period_in_sec_.count());
+
+        if (!b->sink_address.empty()) {
+            b->sink.bind(b->sink_address, b->name);
+            b->shared_truth = b->sink.retrieve();
+        }
+    }
+}
+
+bool SyntheticFrame::serveFrame() {
+
+    // Simulated time of this frame
+    const oat::Sample::Microseconds usec {static_cast<int64_t>(
+        std::round(frames_served_ * frame_period_in_sec_.count() * 1e6))};
+
+    for (auto &b : blobs_)
+        simulateMotion(*b);
+
+    if (frames_served_ == 0)
+        start_ = Clock::now();
+
+    const cv::Rect frame_rect(0, 0, width_, height_);
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sources to read
+    frame_sink_.wait();
+
+    // The shared frame persists between samples, so only the areas covered
+    // by blobs need to be redrawn
+    for (auto &b : blobs_)
+        shared_frame_(b->drawn).setTo(background_);
+
+    for (auto &b : blobs_) {
+
+        const cv::Point center(
+            static_cast<int>(std::round(b->state(0) * (1 << DRAW_SHIFT))),
+            static_cast<int>(std::round(b->state(2) * (1 << DRAW_SHIFT))));
+
+        cv::circle(shared_frame_, center, b->radius << DRAW_SHIFT, b->color,
+                   -1, cv::LINE_8, DRAW_SHIFT);
+
+        b->drawn = cv::Rect(static_cast<int>(b->state(0)) - b->radius - 1,
+                            static_cast<int>(b->state(2)) - b->radius - 1,
+                            2 * b->radius + 3,
+                            2 * b->radius + 3) & frame_rect;
+    }
+
+    // Increment sample count and tell sources there is new data
+    postFrame(usec);
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    // Publish ground truth with the same sample count and time as the frame
+    const oat::Sample::Microseconds frame_usec =
+        shared_frame_.sample().microseconds();
+
+    for (auto &b : blobs_) {
+
+        b->truth.position.x = b->state(0);
+        b->truth.position.y = b->state(2);
+        b->truth.velocity.x = b->state(1);
+        b->truth.velocity.y = b->state(3);
+        b->truth.sample().incrementCount(frame_usec);
+
+        if (b->shared_truth == nullptr)
+            continue;
+
+        // START CRITICAL SECTION //
+        ////////////////////////////
+
+        b->sink.wait();
+
+        *b->shared_truth = b->truth;
+
+        b->sink.post();
+
+        ////////////////////////////
+        //  END CRITICAL SECTION  //
+    }
+
+    frames_served_++;
+
+    // Enforce the correct frame rate against an absolute deadline
+    if (!unthrottled_) {
+        std::this_thread::sleep_until(start_ +
+            std::chrono::duration_cast<Clock::duration>(
+                frame_period_in_sec_ * frames_served_));
+    }
+
+    // Never reaches END state
+    return false;
+}
+
+void SyntheticFrame::simulateMotion(Blob &blob) {
+
+    // Discrete white noise acceleration model, as in RandomAccel2D
+    const double Ts = frame_period_in_sec_.count();
+    const double ax = accel_distribution_(accel_generator_);
+    const double ay = accel_distribution_(accel_generator_);
+
+    cv::Matx41d &s = blob.state;
+    s(0) += Ts * s(1) + 0.5 * Ts * Ts * ax;
+    s(1) += Ts * ax;
+    s(2) += Ts * s(3) + 0.5 * Ts * Ts * ay;
+    s(3) += Ts * ay;
+
+    // Wrap around the frame boundaries
+    if (s(0) < 0)
+        s(0) = width_;
+
+    if (s(0) > width_)
+        s(0) = 0;
+
+    if (s(2) < 0)
+        s(2) = height_;
+
+    if (s(2) > height_)
+        s(2) = 0;
+}
+
+void SyntheticFrame::calculateFramePeriod() {
+
+    std::chrono::duration<double> frame_period {1.0 / frame_rate_in_hz_};
+
+    // Automatic conversion
+    frame_period_in_sec_ = frame_period;
+}
+
+} /* namespace oat */
@@ -0,0 +1,107 @@
+//******************************************************************************
+//* File:   SyntheticFrame.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_SYNTHETICFRAME_H
+#define	OAT_SYNTHETICFRAME_H
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "../../lib/datatypes/Position2D.h"
+#include "../../lib/shmemdf/Sink.h"
+
+#include "FrameServer.h"
+
+namespace oat {
+
+/**
+ * Renders colored blobs subject to random, uncorrelated 2D Gaussian
+ * accelerations (the RandomAccel2D motion model). The true position of each
+ * blob can be published to its own position SINK for measuring detection
+ * error and latency.
+ */
+class SyntheticFrame : public FrameServer {
+public:
+
+    SyntheticFrame(const std::string &frame_sink_address,
+                   const double frames_per_second = 30);
+
+    // Implement FrameServer interface
+    void configure(void) override;
+    void configure(const std::string &config_file,
+                   const std::string &config_key) override;
+    void connectToNode(void) override;
+    bool serveFrame(void) override;
+
+private:
+
+    struct Blob {
+
+        explicit Blob(const std::string &blob_name) :
+          name(blob_name)
+        , truth(blob_name)
+        {
+            // Nothing
+        }
+
+        std::string name;
+        cv::Scalar color {255, 255, 255};
+        int radius {20};
+
+        // State is [x, vx, y, vy]
+        cv::Matx41d state {0.0, 0.0, 0.0, 0.0};
+
+        // Area that was drawn on the previous frame
+        cv::Rect drawn;
+
+        // Ground truth
+        std::string sink_address;
+        oat::Position2D truth;
+        oat::Sink<oat::Position2D> sink;
+        oat::Position2D *shared_truth {nullptr};
+    };
+
+    // Frame geometry and background
+    int64_t width_ {640};
+    int64_t height_ {480};
+    cv::Scalar background_ {0, 0, 0};
+    std::vector<std::unique_ptr<Blob>> blobs_;
+
+    // Motion model
+    std::default_random_engine accel_generator_ {std::random_device{}()};
+    std::normal_distribution<double> accel_distribution_ {0.0, 100.0};
+    void simulateMotion(Blob &blob);
+
+    // Frame generation clock. Frame n is published at start_ + n * period so
+    // that timing error does not accumulate.
+    using Clock = std::chrono::steady_clock;
+    double frame_rate_in_hz_;
+    bool unthrottled_ {false};
+    std::chrono::duration<double> frame_period_in_sec_;
+    Clock::time_point start_;
+    uint64_t frames_served_ {0};
+    void calculateFramePeriod(void);
+};
+
+}       /* namespace oat */
+#endif	/* OAT_SYNTHETICFRAME_H */
@@ -68,11 +68,8 @@ bool TestFrame::serveFrame() {
     // Wait for sources to read
     frame_sink_.wait();
 
-    // Increment sample count
-    shared_frame_.sample().incrementCount();
-
-    // Tell sources there is new data
-    frame_sink_.post();
+    // Increment sample count and tell sources there is new data
+    postFrame();
 
     ////////////////////////////
     //  END CRITICAL SECTION  //
@@ -0,0 +1,464 @@
+//******************************************************************************
+//* File:   V4L2Cam.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "V4L2Cam.h"
+
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <opencv2/core/mat.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <cpptoml.h>
+
+#include "../../lib/utility/OatTOMLSanitize.h"
+#include "../../lib/utility/IOFormat.h"
+
+namespace oat {
+
+V4L2Cam::V4L2Cam(const std::string &frame_sink_address, const size_t index) :
+  FrameServer(frame_sink_address)
+, device_("/dev/video" + std::to_string(index))
+{
+    // Nothing
+}
+
+V4L2Cam::~V4L2Cam() {
+
+    stopStreaming();
+
+    for (auto &b : buffers_) {
+        if (b.start != nullptr && b.start != MAP_FAILED)
+            munmap(b.start, b.length);
+    }
+
+    if (fd_ != -1)
+        close(fd_);
+}
+
+void V4L2Cam::connectToNode() {
+
+    openDevice();
+    setupFormat();
+    setupBuffers();
+
+    // GREY frames are published as CV_8UC1; YUYV and MJPEG frames are
+    // converted to BGR
+    int type = fourcc_ == V4L2_PIX_FMT_GREY ? CV_8UC1 : CV_8UC3;
+    int rows = use_roi_ ? region_of_interest_.height : height_;
+    int cols = use_roi_ ? region_of_interest_.width : width_;
+
+    frame_sink_.bind(frame_sink_address_, rows * cols * CV_ELEM_SIZE(type));
+    shared_frame_ = frame_sink_.retrieve(rows, cols, type);
+
+    // Get the frame period that the driver settled on
+    v4l2_streamparm parm {};
+    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(VIDIOC_G_PARM, &parm) == 0
+        && parm.parm.capture.timeperframe.denominator > 0) {
+        shared_frame_.sample().set_period_sec(
+            static_cast<double>(parm.parm.capture.timeperframe.numerator)
+            / parm.parm.capture.timeperframe.denominator);
+    }
+
+    startStreaming();
+}
+
+bool V4L2Cam::serveFrame() {
+
+    // Wait for the driver to fill a buffer. On timeout, return to allow a
+    // check to see if SIGINT occurred.
+    pollfd pfd {fd_, POLLIN, 0};
+    int rc = poll(&pfd, 1, POLL_TIMEOUT_MS);
+    if (rc == 0 || (rc == -1 && errno == EINTR))
+        return false;
+    else if (rc == -1)
+        throw std::runtime_error("Failed to poll " + device_ + ": "
+                                 + std::strerror(errno));
+
+    v4l2_buffer buf {};
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+
+    if (xioctl(VIDIOC_DQBUF, &buf) == -1) {
+        if (errno == EAGAIN)
+            return false;
+        throw std::runtime_error("Failed to dequeue buffer from " + device_
+                                 + ": " + std::strerror(errno));
+    }
+
+    publish(buf);
+
+    // Give the buffer back to the driver
+    if (xioctl(VIDIOC_QBUF, &buf) == -1)
+        throw std::runtime_error("Failed to queue buffer on " + device_
+                                 + ": " + std::strerror(errno));
+
+    return false;
+}
+
+void V4L2Cam::publish(const v4l2_buffer &buf) {
+
+    // Driver timestamp, relative to the first frame
+    oat::Sample::Microseconds usec {
+        static_cast<int64_t>(buf.timestamp.tv_sec) * 1000000
+        + buf.timestamp.tv_usec};
+
+    if (first_frame_) {
+        start_usec_ = usec;
+    } else if (buf.sequence > last_sequence_ + 1) {
+        std::cerr << oat::Warn("Driver dropped "
+                               + std::to_string(buf.sequence - last_sequence_ - 1)
+                               + " frame(s).\n");
+        dropped_ += buf.sequence - last_sequence_ - 1;
+    }
+
+    first_frame_ = false;
+    last_sequence_ = buf.sequence;
+
+    void *data = buffers_[buf.index].start;
+    cv::Mat raw;
+    cv::Rect roi(region_of_interest_.x, region_of_interest_.y,
+                 region_of_interest_.width, region_of_interest_.height);
+
+    switch (fourcc_) {
+        case V4L2_PIX_FMT_BGR24:
+            raw = cv::Mat(height_, width_, CV_8UC3, data, bytes_per_line_);
+            break;
+        case V4L2_PIX_FMT_RGB24:
+            raw = cv::Mat(height_, width_, CV_8UC3, data, bytes_per_line_);
+            break;
+        case V4L2_PIX_FMT_GREY:
+            raw = cv::Mat(height_, width_, CV_8UC1, data, bytes_per_line_);
+            break;
+        case V4L2_PIX_FMT_YUYV:
+        case V4L2_PIX_FMT_UYVY:
+            raw = cv::Mat(height_, width_, CV_8UC2, data, bytes_per_line_);
+            break;
+        case V4L2_PIX_FMT_MJPEG:
+            // Decoding is expensive, so do it outside the critical section
+            cv::imdecode(cv::Mat(1, buf.bytesused, CV_8UC1, data),
+                         cv::IMREAD_COLOR, &raw);
+            if (raw.empty()) {
+                dropped_++;
+                return;
+            }
+            break;
+    }
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sources to read
+    frame_sink_.wait();
+
+    // Copy or convert the driver buffer directly into the shared frame
+    switch (fourcc_) {
+        case V4L2_PIX_FMT_BGR24:
+        case V4L2_PIX_FMT_GREY:
+        case V4L2_PIX_FMT_MJPEG:
+            if (!use_roi_)
+                raw.copyTo(shared_frame_);
+            else
+                raw(roi).copyTo(shared_frame_);
+            break;
+        case V4L2_PIX_FMT_RGB24:
+            cv::cvtColor(use_roi_ ? raw(roi) : raw, shared_frame_,
+                         cv::COLOR_RGB2BGR);
+            break;
+        case V4L2_PIX_FMT_YUYV:
+        case V4L2_PIX_FMT_UYVY:
+        {
+            int code = fourcc_ == V4L2_PIX_FMT_YUYV ? cv::COLOR_YUV2BGR_YUYV
+                                                    : cv::COLOR_YUV2BGR_UYVY;
+            if (!use_roi_) {
+                cv::cvtColor(raw, shared_frame_, code);
+            } else {
+                // Chroma is shared between pixel pairs, so convert the
+                // whole frame before cropping
+                cv::Mat bgr;
+                cv::cvtColor(raw, bgr, code);
+                bgr(roi).copyTo(shared_frame_);
+            }
+            break;
+        }
+    }
+
+    // Record frames that will never be published
+    shared_frame_.sample().incrementDropped(dropped_);
+    dropped_ = 0;
+
+    // Increment sample count and tell sources there is new data
+    postFrame(usec - start_usec_);
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+}
+
+void V4L2Cam::configure() { }
+
+void V4L2Cam::configure(const std::string& config_file,
+                        const std::string& config_key) {
+
+    // Available options
+    std::vector<std::string> options {"index",
+                                      "device",
+                                      "buffers",
+                                      "pixel_format",
+                                      "width",
+                                      "height",
+                                      "fps",
+                                      "roi"};
+
+    // This will throw cpptoml::parse_exception if a file
+    // with invalid TOML is provided
+    auto config = cpptoml::parse_file(config_file);
+
+    // See if a camera configuration was provided
+    if (config->contains(config_key)) {
+
+        // Get this components configuration table
+        auto this_config = config->get_table(config_key);
+
+        // Check for unknown options in the table and throw if you find them
+        oat::config::checkKeys(options, this_config);
+
+        // Set the device, either by index or by path
+        int64_t index;
+        if (oat::config::getValue(this_config, "index", index, (int64_t)0))
+            device_ = "/dev/video" + std::to_string(index);
+        oat::config::getValue(this_config, "device", device_);
+
+        // Number of driver buffers
+        oat::config::getValue(this_config, "buffers", num_buffers_, (int64_t)2);
+
+        // Capture format
+        if (oat::config::getValue(this_config, "pixel_format", pixel_format_)
+            && pixel_format_.size() != 4) {
+            throw std::runtime_error("pixel_format must be a four character "
+                                     "code, e.g. \"YUYV\".");
+        }
+        oat::config::getValue(this_config, "width", width_, (int64_t)1);
+        oat::config::getValue(this_config, "height", height_, (int64_t)1);
+        oat::config::getValue(this_config, "fps", frames_per_second_, 0.0);
+
+        // Set the ROI
+        oat::config::Table roi;
+        if (oat::config::getTable(this_config, "roi", roi)) {
+
+            int64_t val;
+            oat::config::getValue(roi, "x_offset", val, (int64_t)0, true);
+            region_of_interest_.x = val;
+            oat::config::getValue(roi, "y_offset", val, (int64_t)0, true);
+            region_of_interest_.y = val;
+            oat::config::getValue(roi, "width", val, (int64_t)0, true);
+            region_of_interest_.width = val;
+            oat::config::getValue(roi, "height", val, (int64_t)0, true);
+            region_of_interest_.height = val;
+            use_roi_ = true;
+        }
+
+    } else {
+        throw (std::runtime_error(oat::configNoTableError(config_key, config_file)));
+    }
+}
+
+void V4L2Cam::openDevice() {
+
+    fd_ = open(device_.c_str(), O_RDWR | O_NONBLOCK);
+    if (fd_ == -1)
+        throw std::runtime_error("Failed to open " + device_ + ": "
+                                 + std::strerror(errno));
+
+    v4l2_capability cap {};
+    if (xioctl(VIDIOC_QUERYCAP, &cap) == -1)
+        throw std::runtime_error(device_ + " is not a V4L2 device.");
+
+    uint32_t caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS)
+                    ? cap.device_caps : cap.capabilities;
+
+    if (!(caps & V4L2_CAP_VIDEO_CAPTURE))
+        throw std::runtime_error(device_ + " is not a video capture device.");
+
+    if (!(caps & V4L2_CAP_STREAMING))
+        throw std::runtime_error(device_ + " does not support streaming I/O.");
+}
+
+void V4L2Cam::setupFormat() {
+
+    const uint32_t requested = v4l2_fourcc(pixel_format_[0], pixel_format_[1],
+                                           pixel_format_[2], pixel_format_[3]);
+
+    switch (requested) {
+        case V4L2_PIX_FMT_BGR24:
+        case V4L2_PIX_FMT_RGB24:
+        case V4L2_PIX_FMT_GREY:
+        case V4L2_PIX_FMT_YUYV:
+        case V4L2_PIX_FMT_UYVY:
+        case V4L2_PIX_FMT_MJPEG:
+            break;
+        default:
+            throw std::runtime_error("Unsupported pixel_format " + pixel_format_
+                                     + ". Use BGR3, RGB3, GREY, YUYV, UYVY, "
+                                     "or MJPG.");
+    }
+
+    // Start from the current format so that unspecified dimensions are kept
+    v4l2_format fmt {};
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(VIDIOC_G_FMT, &fmt) == -1)
+        throw std::runtime_error("Failed to get format of " + device_ + ": "
+                                 + std::strerror(errno));
+
+    fmt.fmt.pix.pixelformat = requested;
+    fmt.fmt.pix.field = V4L2_FIELD_NONE;
+    if (width_ > 0)
+        fmt.fmt.pix.width = width_;
+    if (height_ > 0)
+        fmt.fmt.pix.height = height_;
+
+    if (xioctl(VIDIOC_S_FMT, &fmt) == -1)
+        throw std::runtime_error("Failed to set format of " + device_ + ": "
+                                 + std::strerror(errno));
+
+    // The driver is free to adjust the request
+    if (fmt.fmt.pix.pixelformat != requested)
+        throw std::runtime_error(device_ + " does not support pixel_format "
+                                 + pixel_format_ + ".");
+
+    fourcc_ = fmt.fmt.pix.pixelformat;
+    width_ = fmt.fmt.pix.width;
+    height_ = fmt.fmt.pix.height;
+    bytes_per_line_ = fmt.fmt.pix.bytesperline;
+
+    if (use_roi_ && (region_of_interest_.x + region_of_interest_.width
+                         > static_cast<size_t>(width_)
+                     || region_of_interest_.y + region_of_interest_.height
+                         > static_cast<size_t>(height_)))
+        throw std::runtime_error("roi does not fit within the "
+                                 + std::to_string(width_) + "x"
+                                 + std::to_string(height_) + " frame.");
+
+    if (frames_per_second_ > 0) {
+
+        v4l2_streamparm parm {};
+        parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        parm.parm.capture.timeperframe.numerator = 1000;
+        parm.parm.capture.timeperframe.denominator =
+            static_cast<uint32_t>(std::round(frames_per_second_ * 1000));
+
+        if (xioctl(VIDIOC_S_PARM, &parm) == -1)
+            std::cerr << oat::Warn("Failed to set frame rate of " + device_
+                                   + ".\n");
+    }
+}
+
+void V4L2Cam::setupBuffers() {
+
+    v4l2_requestbuffers req {};
+    req.count = num_buffers_;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+
+    if (xioctl(VIDIOC_REQBUFS, &req) == -1)
+        throw std::runtime_error(device_ + " does not support memory mapped "
+                                 "streaming: " + std::strerror(errno));
+
+    if (req.count < 2)
+        throw std::runtime_error("Insufficient buffer memory on " + device_ + ".");
+
+    if (static_cast<int64_t>(req.count) != num_buffers_)
+        std::cerr << oat::Warn("Driver allocated " + std::to_string(req.count)
+                               + " buffers.\n");
+
+    buffers_.resize(req.count);
+
+    for (uint32_t i = 0; i < req.count; i++) {
+
+        v4l2_buffer buf {};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+
+        if (xioctl(VIDIOC_QUERYBUF, &buf) == -1)
+            throw std::runtime_error("Failed to query buffer on " + device_
+                                     + ": " + std::strerror(errno));
+
+        buffers_[i].length = buf.length;
+        buffers_[i].start = mmap(nullptr, buf.length, PROT_READ | PROT_WRITE,
+                                 MAP_SHARED, fd_, buf.m.offset);
+
+        if (buffers_[i].start == MAP_FAILED)
+            throw std::runtime_error("Failed to map buffer on " + device_
+                                     + ": " + std::strerror(errno));
+    }
+}
+
+void V4L2Cam::startStreaming() {
+
+    for (uint32_t i = 0; i < buffers_.size(); i++) {
+
+        v4l2_buffer buf {};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+
+        if (xioctl(VIDIOC_QBUF, &buf) == -1)
+            throw std::runtime_error("Failed to queue buffer on " + device_
+                                     + ": " + std::strerror(errno));
+    }
+
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(VIDIOC_STREAMON, &type) == -1)
+        throw std::runtime_error("Failed to start streaming on " + device_
+                                 + ": " + std::strerror(errno));
+
+    streaming_ = true;
+}
+
+void V4L2Cam::stopStreaming() {
+
+    if (!streaming_)
+        return;
+
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    xioctl(VIDIOC_STREAMOFF, &type);
+    streaming_ = false;
+}
+
+int V4L2Cam::xioctl(unsigned long request, void *arg) {
+
+    int rc;
+    do {
+        rc = ioctl(fd_, request, arg);
+    } while (rc == -1 && errno == EINTR);
+
+    return rc;
+}
+
+} /* namespace oat */
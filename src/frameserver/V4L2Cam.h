@@ -0,0 +1,101 @@
+//******************************************************************************
+//* File:   V4L2Cam.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_V4L2CAM_H
+#define	OAT_V4L2CAM_H
+
+#include <string>
+#include <vector>
+#include <linux/videodev2.h>
+
+#include "../../lib/datatypes/Sample.h"
+
+#include "FrameServer.h"
+
+namespace oat {
+
+/**
+ * Video4Linux2 camera using memory-mapped driver buffers. Frames are
+ * dequeued from the driver and copied (or converted) once, directly into
+ * the shared frame, and are timestamped by the driver.
+ */
+class V4L2Cam : public FrameServer {
+public:
+
+    V4L2Cam(const std::string &frame_sink_address, const size_t index);
+
+    ~V4L2Cam();
+
+    // Implement FrameServer interface
+    void configure(void) override;
+    void configure(const std::string &config_file,
+                   const std::string &config_key) override;
+    void connectToNode(void) override;
+    bool serveFrame(void) override;
+
+private:
+
+    // Memory-mapped driver buffer
+    struct MappedBuffer {
+        void *start {nullptr};
+        size_t length {0};
+    };
+
+    // Device
+    std::string device_;
+    int fd_ {-1};
+    bool streaming_ {false};
+
+    // Requested capture format
+    int64_t num_buffers_ {4};
+    int64_t width_ {0};
+    int64_t height_ {0};
+    double frames_per_second_ {0.0};
+    std::string pixel_format_ {"YUYV"};
+
+    // Negotiated capture format
+    uint32_t fourcc_ {0};
+    uint32_t bytes_per_line_ {0};
+    std::vector<MappedBuffer> buffers_;
+
+    // Driver timestamps are reported relative to the first frame
+    bool first_frame_ {true};
+    oat::Sample::Microseconds start_usec_ {0};
+    uint32_t last_sequence_ {0};
+
+    // Frames acquired since the last published frame that will never be
+    // published
+    uint64_t dropped_ {0};
+
+    // Wait time for a frame before checking for interrupts
+    static constexpr int POLL_TIMEOUT_MS {1000};
+
+    void openDevice(void);
+    void setupFormat(void);
+    void setupBuffers(void);
+    void startStreaming(void);
+    void stopStreaming(void);
+    void publish(const v4l2_buffer &buf);
+
+    // ioctl wrapper that retries on EINTR
+    int xioctl(unsigned long request, void *arg);
+};
+
+}      /* namespace oat */
+#endif /* OAT_V4L2CAM_H */
@@ -19,6 +19,7 @@
 
 #include "WebCam.h"
 
+#include <chrono>
 #include <string>
 #include <opencv2/core/mat.hpp>
 #include <opencv2/videoio.hpp>
@@ -38,6 +39,16 @@ WebCam::WebCam(const std::string &frame_sink_name) :
     // Nothing
 }
 
+WebCam::~WebCam() {
+
+    // The capture thread only blocks on the camera, so it will see this
+    // after at most one more frame
+    capturing_ = false;
+
+    if (capture_thread_.joinable())
+        capture_thread_.join();
+}
+
 void WebCam::connectToNode() {
 
     cv_camera_ = std::make_unique<cv::VideoCapture>(index_);
@@ -56,35 +67,111 @@ void WebCam::connectToNode() {
 
     // TODO: this does not appear to be very accurate/work
     shared_frame_.sample().set_rate_hz(cv_camera_->get(CV_CAP_PROP_FPS));
+
+    // Start draining the camera
+    ring_.resize(buffer_size_);
+    capturing_ = true;
+    capture_thread_ = std::thread(&WebCam::captureFrames, this);
+}
+
+void WebCam::captureFrames() {
+
+    // Frames are swapped in and out of the ring, so after the first few
+    // captures no allocation occurs
+    cv::Mat captured;
+
+    while (capturing_) {
+
+        cv_camera_->read(captured);
+
+        bool eof = false;
+        {
+            std::lock_guard<std::mutex> lk(ring_mutex_);
+
+            if (captured.empty()) {
+                eof = capture_eof_ = true;
+            } else {
+
+                size_t tail = (ring_head_ + ring_count_) % ring_.size();
+
+                // If the ring is full, overwrite the oldest frame
+                if (ring_count_ == ring_.size()) {
+                    ring_head_ = (ring_head_ + 1) % ring_.size();
+                    dropped_++;
+                } else {
+                    ring_count_++;
+                }
+
+                cv::swap(ring_[tail], captured);
+            }
+        }
+
+        frame_ready_cv_.notify_one();
+
+        if (eof)
+            break;
+    }
 }
 
 bool WebCam::serveFrame() {
 
+    uint64_t dropped = 0;
+
+    // Take a frame from the ring. This occurs outside the critical section
+    // so that SOURCEs are not held up waiting on the camera.
+    {
+        std::unique_lock<std::mutex> lk(ring_mutex_);
+
+        // Time out periodically to allow a check to see if SIGINT occurred
+        if (!frame_ready_cv_.wait_for(lk, std::chrono::seconds(1), [this] {
+                return ring_count_ > 0 || capture_eof_;
+            }))
+            return false;
+
+        // The camera stopped producing frames and the ring is exhausted
+        frame_empty_ = ring_count_ == 0;
+        if (frame_empty_)
+            return true;
+
+        size_t idx;
+        if (publish_newest_) {
+
+            // Skip straight to the most recent frame
+            idx = (ring_head_ + ring_count_ - 1) % ring_.size();
+            dropped_ += ring_count_ - 1;
+            ring_head_ = (idx + 1) % ring_.size();
+            ring_count_ = 0;
+
+        } else {
+
+            idx = ring_head_;
+            ring_head_ = (ring_head_ + 1) % ring_.size();
+            ring_count_--;
+        }
+
+        // Hand the previously published frame back to the ring
+        cv::swap(ring_[idx], frame_);
+
+        dropped = dropped_;
+        dropped_ = 0;
+    }
+
     // START CRITICAL SECTION //
     ////////////////////////////
 
     // Wait for sources to read
     frame_sink_.wait();
 
-    if (!use_roi_) {
-            
-        *cv_camera_ >> shared_frame_;
-        frame_empty_ = shared_frame_.empty();
+    if (!use_roi_)
+        frame_.copyTo(shared_frame_);
+    else
+        frame_(region_of_interest_).copyTo(shared_frame_);
 
-    } else {
+    // Record frames that will never be published
+    shared_frame_.sample().incrementDropped(dropped);
 
-        oat::Frame to_crop;
-        *cv_camera_ >> to_crop;
-        if (!(frame_empty_ = to_crop.empty()))
-            to_crop = to_crop(region_of_interest_);
-        to_crop.copyTo(shared_frame_);
-    }
-
-    // Increment sample count
-    shared_frame_.sample().incrementCount();
-
-    // Tell sources there is new data
-    frame_sink_.post();
+    // Increment sample count and tell sources there is new data
+    postFrame();
 
     ////////////////////////////
     //  END CRITICAL SECTION  //
@@ -97,7 +184,7 @@ void WebCam::configure() { }
 void WebCam::configure(const std::string& config_file, const std::string& config_key) {
 
     // Available options
-    std::vector<std::string> options {"index", "roi"};
+    std::vector<std::string> options {"index", "roi", "buffer_size", "publish"};
 
     // This will throw cpptoml::parse_exception if a file
     // with invalid TOML is provided
@@ -116,6 +203,21 @@ void WebCam::configure(const std::string& config_file, const std::string& config
         oat::config::getValue(this_config, "index", index_, MIN_INDEX);
         //cv_camera_ = std::make_unique<cv::VideoCapture>(index_);
 
+        // Number of captured frames that can wait for publication
+        oat::config::getValue(this_config, "buffer_size", buffer_size_, (int64_t)1);
+
+        // Publish the newest captured frame or the next one in sequence
+        std::string publish;
+        if (oat::config::getValue(this_config, "publish", publish)) {
+            if (publish == "newest")
+                publish_newest_ = true;
+            else if (publish == "next")
+                publish_newest_ = false;
+            else
+                throw (std::runtime_error("Invalid value for 'publish': "
+                                          + publish + ". Use newest or next."));
+        }
+
         // Set the ROI
         oat::config::Table roi;
         if (oat::config::getTable(this_config, "roi", roi)) {
@@ -20,7 +20,14 @@
 #ifndef OAT_WEBCAM_H
 #define OAT_WEBCAM_H
 
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
+
 #include "FrameServer.h"
 
 // Forward declaration
@@ -36,6 +43,8 @@ public:
 
     WebCam(const std::string &frame_sink_address_);
 
+    ~WebCam();
+
     // Implement FrameServer interface
     void configure(void) override;
     void configure(const std::string &config_file, 
@@ -51,6 +60,24 @@ private:
     // The webcam object
     int64_t index_;
     std::unique_ptr<cv::VideoCapture> cv_camera_;
+
+    // Capture thread. The camera is drained continuously into a ring of
+    // buffer_size_ frames so that driver buffers never overflow while
+    // SOURCEs are slow. Frames that are overwritten in, or skipped over
+    // in, the ring are counted as dropped.
+    int64_t buffer_size_ {3};
+    bool publish_newest_ {true};
+    std::vector<cv::Mat> ring_;
+    size_t ring_head_ {0};
+    size_t ring_count_ {0};
+    uint64_t dropped_ {0};
+    bool capture_eof_ {false};
+    cv::Mat frame_;
+    std::atomic<bool> capturing_ {false};
+    std::thread capture_thread_;
+    std::mutex ring_mutex_;
+    std::condition_variable frame_ready_cv_;
+    void captureFrames(void);
 };
 
 }      /* namespace oat */
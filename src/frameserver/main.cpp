@@ -32,11 +32,18 @@
 #include "../../lib/utility/IOFormat.h"
 
 #include "TestFrame.h"
+#include "SyntheticFrame.h"
 #include "FileReader.h"
+#include "RawFileReader.h"
+#include "ImageSequence.h"
 #include "WebCam.h"
+#include "MultiServer.h"
 #ifdef USE_FLYCAP
     #include "PGGigECam.h"
 #endif
+#ifdef USE_V4L2
+    #include "V4L2Cam.h"
+#endif
 
 namespace po = boost::program_options;
 
@@ -51,7 +58,12 @@ void printUsage(po::options_description options) {
               << "  wcam: Onboard or USB webcam.\n"
               << "  gige: Point Grey GigE camera.\n"
               << "  file: Video from file (*.mpg, *.avi, etc.).\n"
-              << "  test: Write-free static image server for performance testing.\n\n"
+              << "  test: Write-free static image server for performance testing.\n"
+              << "  v4l2: Video4Linux2 device using memory mapped driver buffers.\n"
+              << "  synth: Synthetic moving blobs with ground truth positions for load testing.\n"
+              << "  raw: Uncompressed raw frame file written by 'oat record --raw'.\n"
+              << "  seq: Sequence of image files (*.png, *.jpg, etc.) in a directory or matching a glob.\n"
+              << "  multi: Several of the above in one process with synchronized samples.\n\n"
               << "SINK:\n"
               << "  User-supplied name of the memory segment to publish frames "
               << "to (e.g. raw).\n\n"
@@ -91,6 +103,7 @@ int main(int argc, char *argv[]) {
     std::string file_path;
     double frames_per_second = 30;
     size_t index = 0;
+    size_t pyramid_levels = 0;
     std::vector<std::string> config_fk;
     bool config_used = false;
     po::options_description visible_options("OPTIONAL ARGUMENTS");
@@ -100,6 +113,11 @@ int main(int argc, char *argv[]) {
     type_hash["gige"] = 'b';
     type_hash["file"] = 'c';
     type_hash["test"] = 'd';
+    type_hash["v4l2"] = 'e';
+    type_hash["synth"] = 'f';
+    type_hash["raw"] = 'g';
+    type_hash["multi"] = 'h';
+    type_hash["seq"] = 'i';
 
     try {
 
@@ -115,9 +133,17 @@ int main(int argc, char *argv[]) {
                 "Index of camera to capture images from.")
                 ("file,f", po::value<std::string>(&file_path),
                 "Path to video file if \'file\' is selected as the server TYPE.\n"
+                "Path to raw frame file if \'raw\' is selected as the server TYPE.\n"
+                "Image directory or glob if \'seq\' is selected as the server TYPE.\n"
                 "Path to image file if \'test\' is selected as the server TYPE.")
                 ("fps,r", po::value<double>(&frames_per_second),
                 "Frames per second. Overriden by information in configuration file if provided.")
+                ("pyramid,p", po::value<size_t>(&pyramid_levels),
+                "Number of downscaled pyramid levels to publish in addition to "
+                "the full resolution frame. Level l is 1/2^l the size of SINK in "
+                "each dimension and is published to SINK_2^l (e.g. raw_2, raw_4). "
+                "Positions detected in a level are in the coordinates of the "
+                "full resolution frame.")
                 ("config,c", po::value<std::vector<std::string> >()->multitoken(),
                 "Configuration file/key pair.")
                 ;
@@ -188,10 +214,11 @@ int main(int argc, char *argv[]) {
             }
         }
 
-        if ((type.compare("file") == 0 || type.compare("test") == 0 )
+        if ((type.compare("file") == 0 || type.compare("test") == 0
+             || type.compare("raw") == 0 || type.compare("seq") == 0)
             && !variable_map.count("file")) {
             printUsage(visible_options);
-            std::cout << oat::Error("When TYPE=file or test, a file path must be specified. Exiting.\n");
+            std::cout << oat::Error("When TYPE=file, test, raw, or seq, a file path must be specified. Exiting.\n");
             return -1;
         }
 
@@ -235,6 +262,42 @@ int main(int argc, char *argv[]) {
             server = std::make_shared<oat::TestFrame>(sink, file_path);
             break;
         }
+        case 'e':
+        {
+
+#ifndef USE_V4L2
+            std::cerr << oat::Error("Oat was not compiled with Video4Linux2 "
+                    "support, so TYPE=v4l2 is not available.\n");
+            return -1;
+#else
+            server = std::make_shared<oat::V4L2Cam>(sink, index);
+#endif
+            break;
+        }
+        case 'f':
+        {
+            server = std::make_shared<oat::SyntheticFrame>(sink, frames_per_second);
+            break;
+        }
+        case 'g':
+        {
+            // Raw files are paced at their recorded sample period unless a
+            // frame rate is given
+            server = std::make_shared<oat::RawFileReader>(
+                sink, file_path, variable_map.count("fps") ? frames_per_second : 0.0);
+            break;
+        }
+        case 'h':
+        {
+            server = std::make_shared<oat::MultiServer>(sink);
+            break;
+        }
+        case 'i':
+        {
+            server =
+                std::make_shared<oat::ImageSequence>(sink, file_path, frames_per_second);
+            break;
+        }
         default:
         {
             printUsage(visible_options);
@@ -253,6 +316,7 @@ int main(int argc, char *argv[]) {
         else
             server->configure();
 
+        server->setPyramidLevels(pyramid_levels);
 
         // Tell user
         std::cout << oat::whoMessage(server->name(),
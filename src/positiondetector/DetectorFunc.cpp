@@ -17,50 +17,470 @@
 //* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
 //****************************************************************************
 
-#include <string>
-#include <vector>
+#include <algorithm>
+#include <cstring>
 #include <opencv2/core/mat.hpp>
 #include <opencv2/imgproc.hpp>
 
 #include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/PositionList2D.h"
 
 #include "DetectorFunc.h"
-#include "HSVDetector.h"
 
 namespace oat {
 
-void siftContours(cv::Mat &frame, Position2D &position, 
-                  double &area, double min_area, double max_area) {
+namespace {
 
-    std::vector<std::vector <cv::Point> > contours;
+// Index of row or column i of a frame of n, reflected about the frame edge
+// without repeating the edge pixel (cv::BORDER_REFLECT_101)
+inline int reflect101(int i, const int n) {
 
-    // NOTE: This function will modify the frame
-    cv::findContours(frame, contours, 
-                     cv::RETR_EXTERNAL, 
-                     cv::CHAIN_APPROX_SIMPLE);
+    if (i >= 0 && i < n)
+        return i;
 
-    double object_area = 0;
-    double countour_area = 0;
+    if (n == 1)
+        return 0;
+
+    while (i < 0 || i >= n)
+        i = i < 0 ? -i : 2 * n - 2 - i;
+
+    return i;
+}
+
+} /* namespace */
+
+void BlobSifter::sift(const cv::Mat &frame, Position2D &position,
+                      double &object_area, double min_area, double max_area,
+                      PositionList2D *blobs) {
+
+    runs_.clear();
+    gaps_.clear();
+    row_runs_.clear();
+    labels_.clear();
+
+    for (int r = 0; r < frame.rows; r++)
+        labelRow(frame.ptr<uint8_t>(r), r, frame.rows, frame.cols);
+    row_runs_.push_back(runs_.size());
+
+    resolveOwners();
+
+    // Each pair of adjacent rows is a row of cells whose corners are pixel
+    // centers
+    upper_.clear();
+    for (int r = 0; r < frame.rows; r++) {
+        ownerIntervals(r, lower_);
+        if (r > 0)
+            accumulateCells(r - 1, frame.cols);
+        std::swap(upper_, lower_);
+    }
+
+    // Isolate the largest blob within the min/max range. findContours lists
+    // the last contour it finds first, so blobs are visited in reverse scan
+    // order to break ties the same way.
+    double area = 0;
     position.position_valid = false;
+    candidates_.clear();
+
+    for (size_t l = labels_.size(); l-- > 0; ) {
+
+        const Label &b = labels_[l];
+        if (!b.foreground || b.owner != static_cast<int>(l))
+            continue;
+
+        const double blob_area = b.a00 * 0.5;
+        if (blob_area > min_area && blob_area < max_area) {
+
+            if (blobs != nullptr)
+                candidates_.push_back(l);
+
+            if (blob_area > area) {
+                position.position.x = b.a10 * (1.0 / 6.0) / blob_area;
+                position.position.y = b.a01 * (1.0 / 6.0) / blob_area;
+                position.position_valid = true;
+                area = blob_area;
+            }
+        }
+    }
+
+    object_area = area;
+
+    if (blobs == nullptr)
+        return;
+
+    // Largest first, breaking ties as above
+    const size_t n = std::min(candidates_.size(), POSITION_LIST_CAPACITY);
+    std::partial_sort(candidates_.begin(), candidates_.begin() + n,
+                      candidates_.end(), [this](int a, int b) {
+        return labels_[a].a00 != labels_[b].a00 ? labels_[a].a00 > labels_[b].a00
+                                                : a > b;
+    });
+
+    blobs->clear();
+    Position2D blob;
+    blob.position_valid = true;
+    for (size_t i = 0; i < n; i++) {
+        const Label &b = labels_[candidates_[i]];
+        const double blob_area = b.a00 * 0.5;
+        blob.position.x = b.a10 * (1.0 / 6.0) / blob_area;
+        blob.position.y = b.a01 * (1.0 / 6.0) / blob_area;
+        blobs->push_back(blob, i);
+    }
+}
+
+int BlobSifter::newLabel(bool foreground, int enclosing, bool border) {
+
+    const int label = labels_.size();
+    labels_.push_back({label, enclosing, -1, foreground, border, 0, 0, 0});
+    return label;
+}
+
+int BlobSifter::find(int label) {
+
+    while (labels_[label].parent != label) {
+        labels_[label].parent = labels_[labels_[label].parent].parent;
+        label = labels_[label].parent;
+    }
+
+    return label;
+}
+
+void BlobSifter::merge(int a, int b) {
+
+    // The root of a component is always its first label, which was created
+    // at its first pixel in scan order
+    a = find(a);
+    b = find(b);
+    if (a < b)
+        labels_[b].parent = a;
+    else if (b < a)
+        labels_[a].parent = b;
+}
+
+void BlobSifter::labelRow(const uint8_t *row, int r, int rows, int cols) {
+
+    const size_t first_run = runs_.size();
+    row_runs_.push_back(first_run);
+
+    // Find the foreground runs, skipping background eight pixels at a time
+    int c = 0;
+    while (true) {
+
+        uint64_t word;
+        while (c + 8 <= cols) {
+            std::memcpy(&word, row + c, sizeof(word));
+            if (word != 0)
+                break;
+            c += 8;
+        }
+
+        while (c < cols && !row[c])
+            c++;
+
+        if (c == cols)
+            break;
+
+        const int start = c;
+        while (c < cols && row[c])
+            c++;
+
+        runs_.push_back({start, c, -1});
+    }
+
+    const size_t num_runs = runs_.size() - first_run;
+
+    // Runs and gaps of the row above
+    size_t run_above = 0, runs_above_end = 0;
+    size_t gap_above = 0, gaps_above_end = 0;
+    size_t enclosing_above = 0;
+    if (r > 0) {
+        run_above = enclosing_above = row_runs_[r - 1];
+        runs_above_end = first_run;
+        gap_above = row_runs_[r - 1] + r - 1;
+        gaps_above_end = first_run + r;
+    }
+
+    // Gaps and runs are labeled left to right so that labels are created in
+    // scan order
+    for (size_t k = 0; k <= num_runs; k++) {
+
+        Run gap {k == 0 ? 0 : runs_[first_run + k - 1].end,
+                 k == num_runs ? cols : runs_[first_run + k].start,
+                 -1};
+
+        if (gap.start < gap.end) {
+
+            const bool border = r == 0 || r == rows - 1
+                                || gap.start == 0 || gap.end == cols;
+
+            // Background is 4-connected to the row above
+            while (gap_above < gaps_above_end && gaps_[gap_above].end <= gap.start)
+                gap_above++;
+
+            for (size_t j = gap_above;
+                 j < gaps_above_end && gaps_[j].start < gap.end; j++) {
+
+                if (gaps_[j].label < 0)
+                    continue;
+
+                if (gap.label < 0)
+                    gap.label = gaps_[j].label;
+                else
+                    merge(gap.label, gaps_[j].label);
+            }
+
+            if (gap.label < 0) {
+
+                // A new region's first pixel lies just below a foreground
+                // run, which surrounds it unless it reaches the frame edge
+                int enclosing = -1;
+                if (!border) {
+                    while (runs_[enclosing_above].end <= gap.start)
+                        enclosing_above++;
+                    enclosing = runs_[enclosing_above].label;
+                }
+
+                gap.label = newLabel(false, enclosing, border);
+
+            } else if (border) {
+                labels_[gap.label].border = true;
+            }
+        }
+
+        gaps_.push_back(gap);
+
+        if (k == num_runs)
+            break;
 
-    for (auto &c : contours) {
+        // Foreground is 8-connected to the row above
+        Run &run = runs_[first_run + k];
 
-        cv::Moments moment = cv::moments(static_cast<cv::Mat>(c));
-        countour_area = moment.m00;
+        while (run_above < runs_above_end && runs_[run_above].end < run.start)
+            run_above++;
 
-        // Isolate the largest contour within the min/max range.
-        if (countour_area > min_area &&
-            countour_area < max_area &&
-            countour_area > object_area) {
+        for (size_t j = run_above;
+             j < runs_above_end && runs_[j].start <= run.end; j++) {
 
-            position.position.x = moment.m10 / countour_area;
-            position.position.y = moment.m01 / countour_area;
-            position.position_valid = true;
-            object_area = countour_area;
+            if (run.label < 0)
+                run.label = runs_[j].label;
+            else
+                merge(run.label, runs_[j].label);
         }
+
+        // A new component's first pixel lies just right of the background
+        // region that surrounds it
+        if (run.label < 0)
+            run.label = newLabel(true, gap.label, false);
+    }
+}
+
+void BlobSifter::resolveOwners() {
+
+    for (size_t l = 0; l < labels_.size(); l++) {
+        if (labels_[l].border)
+            labels_[find(l)].border = true;
+    }
+
+    // Components are resolved in scan order, after the components that
+    // enclose them. External components own themselves and background
+    // regions touching the frame edge are owned by none. Holes, and
+    // everything inside them, belong to the component enclosing the hole.
+    for (size_t l = 0; l < labels_.size(); l++) {
+
+        Label &x = labels_[l];
+        const int root = find(l);
+
+        if (root != static_cast<int>(l)) {
+            x.owner = labels_[root].owner;
+        } else if (x.foreground) {
+            const int e = x.enclosing < 0 ? -1 : find(x.enclosing);
+            x.owner = (e < 0 || labels_[e].border) ? root : labels_[e].owner;
+        } else {
+            x.owner = x.border ? -1 : labels_[find(x.enclosing)].owner;
+        }
+    }
+}
+
+void BlobSifter::ownerIntervals(int r, std::vector<Run> &intervals) {
+
+    intervals.clear();
+
+    const size_t first_run = row_runs_[r];
+    const size_t num_runs = row_runs_[r + 1] - first_run;
+    const size_t first_gap = first_run + r;
+
+    // Gaps and runs alternate, and adjacent pixels with an owner have the
+    // same owner
+    for (size_t k = 0; k <= 2 * num_runs; k++) {
+
+        const Run &run = (k % 2 == 0) ? gaps_[first_gap + k / 2]
+                                      : runs_[first_run + k / 2];
+
+        if (run.label < 0 || run.start == run.end)
+            continue;
+
+        const int owner = labels_[run.label].owner;
+        if (owner < 0)
+            continue;
+
+        if (!intervals.empty() && intervals.back().end == run.start)
+            intervals.back().end = run.end;
+        else
+            intervals.push_back({run.start, run.end, owner});
+    }
+}
+
+void BlobSifter::accumulateCells(int y, int cols) {
+
+    // The region enclosed by an external contour through pixel centers
+    // contains the cells whose four corners belong to its component, and
+    // half of those with three, cut along the diagonal that joins them.
+    // Cells with fewer lie on the contour.
+    const std::vector<Run> &top = upper_;
+    const std::vector<Run> &bottom = lower_;
+
+    // Full cells
+    for (size_t i = 0, j = 0; i < top.size() && j < bottom.size(); ) {
+
+        const int lo = std::max(top[i].start, bottom[j].start);
+        const int hi = std::min(top[i].end, bottom[j].end);
+
+        if (hi - lo >= 2) {
+            const int64_t n = hi - lo - 1;
+            Label &o = labels_[top[i].label];
+            o.a00 += 2 * n;
+            o.a10 += 3 * n * (lo + hi - 1);
+            o.a01 += 3 * n * (2 * y + 1);
+        }
+
+        if (top[i].end < bottom[j].end)
+            i++;
+        else
+            j++;
     }
 
-    area = object_area;
+    // Half cells at the ends of the intervals of one row, where the other
+    // row covers both columns
+    auto triangles = [&](const std::vector<Run> &edge, int ye,
+                         const std::vector<Run> &full, int yf) {
+
+        size_t p = 0;
+        auto covers = [&](int x) {
+            while (p < full.size() && full[p].end < x + 2)
+                p++;
+            return p < full.size() && full[p].start <= x;
+        };
+
+        for (const auto &e : edge) {
+
+            if (e.start > 0 && covers(e.start - 1)) {
+                Label &o = labels_[e.label];
+                o.a00 += 1;
+                o.a10 += 3 * e.start - 1;
+                o.a01 += ye + 2 * yf;
+            }
+
+            if (e.end < cols && covers(e.end - 1)) {
+                Label &o = labels_[e.label];
+                o.a00 += 1;
+                o.a10 += 3 * e.end - 2;
+                o.a01 += ye + 2 * yf;
+            }
+        }
+    };
+
+    triangles(top, y, bottom, y + 1);
+    triangles(bottom, y + 1, top, y);
+}
+
+void differenceThreshold(const cv::Mat &current,
+                         const cv::Mat &last,
+                         const int threshold,
+                         const uint8_t value,
+                         cv::Mat &motion) {
+
+    const uint8_t t = std::min(threshold, 255);
+
+    for (int r = 0; r < current.rows; r++) {
+
+        const uint8_t * __restrict a = current.ptr<uint8_t>(r);
+        const uint8_t * __restrict b = last.ptr<uint8_t>(r);
+        uint8_t * __restrict m = motion.ptr<uint8_t>(r);
+
+        for (int c = 0; c < current.cols; c++) {
+            const uint8_t d = std::max(a[c], b[c]) - std::min(a[c], b[c]);
+            m[c] = d > t ? value : 0;
+        }
+    }
+}
+
+int minBoxCount(const cv::Size &ksize, int threshold) {
+
+    // Blurred value at the center of a box holding count pixels of 255
+    cv::Mat box(ksize, CV_8UC1), blurred;
+    auto passes = [&](int count) {
+        box.setTo(0);
+        box.reshape(1, 1).colRange(0, count).setTo(255);
+        cv::blur(box, blurred, ksize);
+        return blurred.at<uint8_t>(ksize.height / 2, ksize.width / 2) > threshold;
+    };
+
+    // The blurred value does not decrease with the count
+    int lo = 0, hi = ksize.area() + 1;
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        if (passes(mid))
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+
+    return lo;
+}
+
+void boxThreshold(const cv::Mat &motion,
+                  const cv::Size &ksize,
+                  const int min_count,
+                  std::vector<int> &column_sums,
+                  cv::Mat &threshold_frame) {
+
+    const int rows = motion.rows;
+    const int cols = motion.cols;
+    const int ax = ksize.width / 2;
+    const int ay = ksize.height / 2;
+
+    // Box sums are kept as running column and row sums
+    column_sums.assign(cols, 0);
+    for (int k = 0; k < ksize.height; k++) {
+        const uint8_t *m = motion.ptr<uint8_t>(reflect101(k - ay, rows));
+        for (int c = 0; c < cols; c++)
+            column_sums[c] += m[c];
+    }
+
+    for (int r = 0; r < rows; r++) {
+
+        if (r > 0) {
+            const uint8_t *in = motion.ptr<uint8_t>(
+                reflect101(r - ay + ksize.height - 1, rows));
+            const uint8_t *out = motion.ptr<uint8_t>(
+                reflect101(r - ay - 1, rows));
+            for (int c = 0; c < cols; c++)
+                column_sums[c] += in[c] - out[c];
+        }
+
+        int sum = 0;
+        for (int k = 0; k < ksize.width; k++)
+            sum += column_sums[reflect101(k - ax, cols)];
+
+        uint8_t *t = threshold_frame.ptr<uint8_t>(r);
+        for (int c = 0; c < cols; c++) {
+
+            if (c > 0)
+                sum += column_sums[reflect101(c - ax + ksize.width - 1, cols)]
+                       - column_sums[reflect101(c - ax - 1, cols)];
+
+            t[c] = sum >= min_count ? 255 : 0;
+        }
+    }
 }
 
 } /* namespace oat */
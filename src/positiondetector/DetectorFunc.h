@@ -20,6 +20,10 @@
 #ifndef OAT_DETECTORFUNC
 #define	OAT_DETECTORFUNC
 
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/types.hpp>
+
 // Forward decl.
 namespace cv { class Mat; }
 
@@ -30,18 +34,119 @@ static constexpr double PI {3.14159265358979323846};
 
 // Forward decl.
 class Position2D;
+class PositionList2D;
+
+/**
+ * Finds the blobs in binary frames by connected component labeling of
+ * horizontal pixel runs. Area and first moments of each blob are accumulated
+ * in the same scan, and are identical to those of the external contours
+ * found by cv::findContours. Buffers are kept between frames, so once they
+ * have grown to fit, sifting a frame allocates nothing.
+ */
+class BlobSifter {
+
+public:
+
+    /**
+     * Given a binary frame, find all blobs and return a position
+     * corresponding to the centroid of the largest one.
+     * @param frame Frame (CV_8UC1) to look for positions in. Non-zero pixels
+     * are foreground.
+     * @param position Position output
+     * @param object_area Area of the largest blob within the min/max range
+     * @param min_area Minimum blob area to be considered candidate for position
+     * @param max_area Maximum blob area to be considered candidate for position
+     * @param blobs If not null, filled with the centroids of every blob within
+     * the min/max range, largest first. Each blob's id is its rank. Only the
+     * largest blobs are kept if there are more than the list can hold.
+     */
+    void sift(const cv::Mat &frame, Position2D &position,
+              double &object_area, double min_area, double max_area,
+              PositionList2D *blobs = nullptr);
+
+private:
+
+    // Horizontal run of pixels and its label. Foreground runs are 8-connected
+    // to the runs of the row above and background runs are 4-connected.
+    struct Run {
+        int start;
+        int end;
+        int label;
+    };
+
+    struct Label {
+        int parent;
+
+        // Background region to the left of a foreground component's first
+        // pixel, or foreground component above a background region's first
+        // pixel (-1 if none)
+        int enclosing;
+
+        // Component whose external contour encloses this one (-1 if none)
+        int owner;
+
+        bool foreground;
+        bool border; // Background touching the frame edge
+
+        // Twice the area, and six times the first moments, of the region
+        // enclosed by an external contour
+        int64_t a00, a10, a01;
+    };
+
+    std::vector<Run> runs_, gaps_;
+    std::vector<size_t> row_runs_; // Row r has gaps row_runs_[r] + r onwards
+    std::vector<Label> labels_;
+    std::vector<Run> upper_, lower_;
+    std::vector<int> candidates_;
+
+    int newLabel(bool foreground, int enclosing, bool border);
+    int find(int label);
+    void merge(int a, int b);
+
+    void labelRow(const uint8_t *row, int r, int rows, int cols);
+    void resolveOwners(void);
+    void ownerIntervals(int r, std::vector<Run> &intervals);
+    void accumulateCells(int y, int cols);
+};
+
+/**
+ * Fused absdiff and threshold of two 8-bit, single channel frames.
+ * @param current Current frame
+ * @param last Last frame
+ * @param threshold Pixels whose intensity changed by more than this are
+ * set to value, and all others to 0
+ * @param value Value of pixels that changed
+ * @param motion Output frame (CV_8UC1), the size of current
+ */
+void differenceThreshold(const cv::Mat &current, const cv::Mat &last,
+                         int threshold, uint8_t value, cv::Mat &motion);
+
+/**
+ * Smallest number of pixels of value 255 within a ksize box, the rest being
+ * 0, for which cv::blur yields more than threshold. cv::blur rounds
+ * differently depending on the kernel area and the OpenCV version, so the
+ * count is found by blurring such boxes rather than by formula.
+ * @param ksize Blur kernel size
+ * @param threshold Threshold applied to the blurred frame
+ * @return Count in [0, ksize.area() + 1]. ksize.area() + 1 if no count
+ * passes.
+ */
+int minBoxCount(const cv::Size &ksize, int threshold);
 
 /**
- * Given a binary frame, find all contours and return a position corresponding
- * to the centroid of the largest one.
- * @param frame_in Frame to look for positions in.
- * @param position Position output
- * @param min_area Minimum contour area to be considered candidate for position
- * @param max_area Maximum contour area to be considered candidate for position
- * @return Position corresponding the centroid of the largest contour in the frame.
+ * Threshold a 0/1 mask after normalized box filtering, as
+ * cv::threshold(cv::blur(255 * mask)) does, without forming the blurred
+ * frame. Borders are reflected as by cv::blur.
+ * @param motion Mask (CV_8UC1) of 0s and 1s
+ * @param ksize Blur kernel size
+ * @param min_count Smallest box count passing the threshold, from
+ * minBoxCount()
+ * @param column_sums Buffer for running column sums
+ * @param threshold_frame Output frame (CV_8UC1) of 0s and 255s, the size of
+ * motion
  */
-void siftContours(cv::Mat &frame, Position2D &position, 
-                  double &object_area, double min_area, double max_area);
+void boxThreshold(const cv::Mat &motion, const cv::Size &ksize, int min_count,
+                  std::vector<int> &column_sums, cv::Mat &threshold_frame);
 
 }       /* namespace oat */
 #endif	/* OAT_DETECTORFUNC */
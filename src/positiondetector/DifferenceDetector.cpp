@@ -20,6 +20,7 @@
 #include "OatConfig.h" // Generated by CMake
 
 #include <string>
+#include <vector>
 #include <opencv2/cvconfig.h>
 #include <opencv2/opencv.hpp>
 #include <cpptoml.h>
@@ -45,24 +46,22 @@ DifferenceDetector::DifferenceDetector(const std::string &frame_source_address,
 
 void DifferenceDetector::detectPosition(cv::Mat &frame, oat::Position2D &position) {
 
-    if (tuning_on_)
-        tune_frame_ = frame.clone();
-
     applyThreshold(frame);
 
-    // Threshold frame will be destroyed by the transform below, so we need to use
-    // it to form the frame that will be shown in the tuning window here
+    // The frame is left intact, so it can be shown in the tuning window. The
+    // whole frame is searched while tuning.
     if (tuning_on_)
-         tune_frame_.setTo(0, threshold_frame_ == 0);
+         frame.setTo(0, threshold_frame_ == 0);
 
-    siftContours(threshold_frame_,
-                 position,
-                 object_area_,
-                 min_object_area_,
-                 max_object_area_);
+    blob_sifter_.sift(threshold_frame_,
+                      position,
+                      object_area_,
+                      min_object_area_,
+                      max_object_area_,
+                      positionList());
 
     if (tuning_on_)
-        tune(tune_frame_, position);
+        tune(frame, position);
 }
 
 void DifferenceDetector::configure(const std::string& config_file,
@@ -73,6 +72,8 @@ void DifferenceDetector::configure(const std::string& config_file,
                                       "diff_threshold",
                                       "min_area",
                                       "max_area",
+                                      "blob_sink",
+                                      "window",
                                       "tune"};
 
     // This will throw cpptoml::parse_exception if a file
@@ -108,6 +109,16 @@ void DifferenceDetector::configure(const std::string& config_file,
         // Maximum object area
         oat::config::getValue(this_config, "max_area", max_object_area_, 0.0);
 
+        // Publish every blob passing the area limits as a position list
+        std::string blob_sink;
+        if (oat::config::getValue(this_config, "blob_sink", blob_sink))
+            setPositionListSink(blob_sink);
+
+        // Search only around the last position
+        oat::config::Table window;
+        if (oat::config::getTable(this_config, "window", window))
+            configureTrackingWindow(window);
+
         // Tuning
         oat::config::getValue(this_config, "tune", tuning_on_);
 
@@ -150,23 +161,56 @@ void DifferenceDetector::tune(cv::Mat &frame, const oat::Position2D &position) {
     cv::waitKey(1);
 }
 
-void DifferenceDetector::applyThreshold(cv::Mat &frame) {
+void DifferenceDetector::applyThreshold(const cv::Mat &frame) {
+
+    // Grayscale frames alternate between two buffers, so the last one is
+    // kept without copying. Frames that are already grayscale (e.g. from
+    // framefilt convert) still need a copy since the next frame replaces them.
+    cv::Mat &current = gray_[current_];
+    const cv::Mat &last = gray_[current_ ^ 1];
+    current_ ^= 1;
+
+    if (frame.channels() != 1)
+        cv::cvtColor(frame, current, cv::COLOR_BGR2GRAY);
+    else
+        frame.copyTo(current);
+
+    // Threshold frames are regions of whole frame buffers, so that tracking
+    // windows of any size need no allocation
+    const cv::Rect window_size(cv::Point(0, 0), search_window_.size());
+    threshold_buffer_.create(frame.size(), CV_8UC1);
+    threshold_frame_ = threshold_buffer_(window_size);
+
+    // Nothing has moved until there is a last frame
+    if (!last_image_set_ || last.size() != current.size()) {
+        threshold_frame_.setTo(0);
+        last_image_set_ = true;
+        return;
+    }
 
-    if (last_image_set_) {
-        cv::cvtColor(frame, frame, cv::COLOR_BGR2GRAY);
-        cv::absdiff(frame, last_image_, threshold_frame_);
-        cv::threshold(threshold_frame_, threshold_frame_, difference_intensity_threshold_, 255, cv::THRESH_BINARY);
-        if (blur_on_) {
-            cv::blur(threshold_frame_, threshold_frame_, blur_size_);
+    // Only the tracking window is differenced and thresholded
+    if (blur_on_) {
+        motion_buffer_.create(frame.size(), CV_8UC1);
+        cv::Mat motion = motion_buffer_(window_size);
+        differenceThreshold(current(search_window_), last(search_window_),
+                            difference_intensity_threshold_, 1, motion);
+
+        // The count that passes the blurred threshold only changes with the
+        // parameters, which the tuning GUI may change at any time
+        if (blur_size_ != box_count_size_
+            || difference_intensity_threshold_ != box_count_threshold_) {
+            box_min_count_ = minBoxCount(blur_size_,
+                                         difference_intensity_threshold_);
+            box_count_size_ = blur_size_;
+            box_count_threshold_ = difference_intensity_threshold_;
         }
-        cv::threshold(threshold_frame_, threshold_frame_, difference_intensity_threshold_, 255, cv::THRESH_BINARY);
-        last_image_ = frame.clone(); // Get a copy of the last image
+
+        boxThreshold(motion, blur_size_, box_min_count_, column_sums_,
+                     threshold_frame_);
     } else {
-        threshold_frame_ = frame.clone();
-        cv::cvtColor(threshold_frame_, threshold_frame_, cv::COLOR_BGR2GRAY);
-        last_image_ = frame.clone();
-        cv::cvtColor(last_image_, last_image_, cv::COLOR_BGR2GRAY);
-        last_image_set_ = true;
+        differenceThreshold(current(search_window_), last(search_window_),
+                            difference_intensity_threshold_, 255,
+                            threshold_frame_);
     }
 }
 
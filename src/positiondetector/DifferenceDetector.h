@@ -22,8 +22,10 @@
 
 #include <string>
 #include <limits>
+#include <vector>
 #include <opencv2/core/mat.hpp>
 
+#include "DetectorFunc.h"
 #include "PositionDetector.h"
 
 namespace oat {
@@ -55,6 +57,8 @@ public:
     void configure(const std::string &config_file,
                    const std::string &config_key) override;
 
+    double objectArea(const size_t) const override { return object_area_; }
+
     //Accessors (used for tuning GUI)
     void set_min_object_area(double value) { min_object_area_ = value; }
     void set_max_object_area(double value) { max_object_area_ = value; }
@@ -62,12 +66,24 @@ public:
 
 private:
 
+    // Grayscale frames, swapped each frame
+    cv::Mat gray_[2];
+    int current_ {0};
+    bool last_image_set_ {false};
+
     // Intermediate variables
-    cv::Mat this_image_, last_image_;
+    cv::Mat motion_buffer_, threshold_buffer_;
     cv::Mat threshold_frame_;
-    bool last_image_set_ {false};
+    std::vector<int> column_sums_;
+
+    // Smallest count of moving pixels within the blur box that passes the
+    // threshold, and the parameters it was found for
+    int box_min_count_ {0};
+    cv::Size box_count_size_;
+    int box_count_threshold_ {-1};
 
     // Object detection
+    oat::BlobSifter blob_sifter_;
     double object_area_;
 
     // Detector parameters
@@ -80,13 +96,12 @@ private:
     // Tuning stuff
     bool tuning_windows_created_ {false};
     const std::string tuning_image_title_;
-    cv::Mat tune_frame_;
     int dummy0_ {0}, dummy1_ {10000};
 
     // Processing functions
     void createTuningWindows(void);
     void tune(cv::Mat &frame, const oat::Position2D &position);
-    void applyThreshold(cv::Mat &frame);
+    void applyThreshold(const cv::Mat &frame);
 };
 
 // Tuning GUI callbacks
@@ -19,7 +19,9 @@
 
 #include "OatConfig.h" // Generated by CMake
 
+#include <cstdint>
 #include <string>
+#include <vector>
 #include <limits>
 #include <opencv2/opencv.hpp>
 #include <cpptoml.h>
@@ -27,15 +29,52 @@
 #include "../../lib/datatypes/Position2D.h"
 #include "../../lib/utility/IOFormat.h"
 #include "../../lib/utility/OatTOMLSanitize.h"
+#include "../../lib/utility/PackedMask.h"
 
 #include "DetectorFunc.h"
 #include "HSVDetector.h"
 
 namespace oat {
 
+namespace {
+
+// Threshold a BGR frame for several targets in one pass. Each pixel's color
+// index, (b << 16) | (g << 8) | r, is computed once and looked up in every
+// target's color lookup table.
+void thresholdColorLUT(const cv::Mat &frame,
+                       const std::vector<const uint8_t *> &luts,
+                       std::vector<cv::Mat *> &threshold_frames) {
+
+    const size_t n = luts.size();
+    std::vector<uint8_t *> t(n);
+
+    for (auto &tf : threshold_frames)
+        tf->create(frame.size(), CV_8UC1);
+
+    for (int r = 0; r < frame.rows; r++) {
+
+        const uint8_t * __restrict f = frame.ptr<uint8_t>(r);
+        for (size_t k = 0; k < n; k++)
+            t[k] = threshold_frames[k]->ptr<uint8_t>(r);
+
+        for (int i = 0; i < frame.cols; i++) {
+
+            const uint32_t idx = static_cast<uint32_t>(f[3 * i]) << 16
+                               | static_cast<uint32_t>(f[3 * i + 1]) << 8
+                               | f[3 * i + 2];
+
+            for (size_t k = 0; k < n; k++)
+                t[k][i] = (luts[k][idx >> 3] >> (idx & 7) & 1) ? 255 : 0;
+        }
+    }
+}
+
+} /* namespace */
+
 HSVDetector::HSVDetector(const std::string &frame_source_address,
                          const std::string &position_sink_address) :
   PositionDetector(frame_source_address, position_sink_address)
+, targets_(1)
 , tuning_image_title_(position_sink_address + "_tuning")
 {
     // Set defaults for the erode and dilate blocks
@@ -47,39 +86,93 @@ HSVDetector::HSVDetector(const std::string &frame_source_address,
 
 void HSVDetector::detectPosition(cv::Mat &frame, oat::Position2D &position) {
 
-    // Transform frame to HSV
-    // (Extremely expensive operation)
-    cv::cvtColor(frame, frame, cv::COLOR_BGR2HSV);
+    // Detect all targets and report the first
+    std::vector<oat::Position2D> positions(targets_.size(), position);
+    detectPositions(frame, positions);
+    position = positions[0];
+}
+
+void HSVDetector::detectPositions(cv::Mat &full_frame,
+                                  std::vector<oat::Position2D> &positions) {
+
+    // Only the tracking window is searched
+    cv::Mat frame = full_frame(search_window_);
+
+    if (color_lut_on_ && !hsv_input_ && frame.type() == CV_8UC3) {
+
+        // Color conversion and thresholding fused into a single lookup
+        // per pixel and target
+        std::vector<const uint8_t *> luts;
+        std::vector<cv::Mat *> threshold_frames;
+        for (auto &t : targets_) {
+
+            if (t.colorLUTStale())
+                t.buildColorLUT();
 
-    // Threshold HSV channels
-    // (Very expensive operation)
-    cv::inRange(frame,
-                cv::Scalar(h_min_, s_min_, v_min_),
-                cv::Scalar(h_max_, s_max_, v_max_),
-                threshold_frame_);
+            luts.push_back(t.color_lut.data());
+            threshold_frames.push_back(&t.threshold_frame);
+        }
+
+        thresholdColorLUT(frame, luts, threshold_frames);
+
+    } else {
+
+        // Transform frame to HSV unless it was converted upstream
+        // (Extremely expensive operation)
+        if (!hsv_input_)
+            cv::cvtColor(frame, frame, cv::COLOR_BGR2HSV);
+
+        // Threshold HSV channels
+        // (Very expensive operation)
+        for (auto &t : targets_)
+            cv::inRange(frame,
+                        cv::Scalar(t.h_min, t.s_min, t.v_min),
+                        cv::Scalar(t.h_max, t.s_max, t.v_max),
+                        t.threshold_frame);
+    }
+
+    if (targets_.size() == 1) {
+        detectTarget(frame, 0, positions[0]);
+    } else {
+
+        if (!target_pool_)
+            target_pool_.reset(new oat::BandPool(targets_.size()));
+
+        target_pool_->run(targets_.size(), [&](size_t i) {
+            detectTarget(frame, i, positions[i]);
+        });
+    }
+
+    // Use the GUI tuner if requested
+    if (tuning_on_)
+        tune(frame, positions[0]);
+}
+
+void HSVDetector::detectTarget(cv::Mat &frame,
+                               const size_t index,
+                               oat::Position2D &position) {
+
+    Target &t = targets_[index];
 
     // Filter the resulting threshold image
     if (erode_on_)
-        cv::erode(threshold_frame_, threshold_frame_, erode_element_);
+        cv::erode(t.threshold_frame, t.threshold_frame, erode_element_);
 
     if (dilate_on_)
-        cv::dilate(threshold_frame_, threshold_frame_, dilate_element_);
+        cv::dilate(t.threshold_frame, t.threshold_frame, dilate_element_);
 
-    // Threshold frame will be destroyed by the transform below, so we need to use
-    // it to form the frame that will be shown in the tuning window here
-    if (tuning_on_)
-        frame.setTo(0, threshold_frame_ == 0).clone();
+    // Form the frame that will be shown in the tuning window. Only the first
+    // target is tuned.
+    if (tuning_on_ && index == 0)
+        frame.setTo(0, t.threshold_frame == 0);
 
-    // Find the largest contour in the threshold image
-    siftContours(threshold_frame_,
+    // Find the largest blob in the threshold image
+    t.blobs.sift(t.threshold_frame,
                  position,
-                 object_area_,
-                 min_object_area_,
-                 max_object_area_);
-
-    // Use the GUI tuner if requested
-    if (tuning_on_)
-        tune(frame, position);
+                 t.object_area,
+                 t.min_area,
+                 t.max_area,
+                 index == 0 ? positionList() : nullptr);
 }
 
 void HSVDetector::configure(const std::string &config_file,
@@ -93,6 +186,11 @@ void HSVDetector::configure(const std::string &config_file,
                                       "h_thresholds",
                                       "s_thresholds",
                                       "v_thresholds",
+                                      "hsv_input",
+                                      "color_lut",
+                                      "targets",
+                                      "blob_sink",
+                                      "window",
                                       "tune" };
 
     // This will throw cpptoml::parse_exception if a file
@@ -123,41 +221,56 @@ void HSVDetector::configure(const std::string &config_file,
             set_dilate_size(val);
         }
 
-        // Minimum object area
-        oat::config::getValue(this_config, "min_area", min_object_area_, 0.0);
+        // Area limits and HSV thresholds of the first target
+        configureTarget(this_config, targets_[0]);
 
-        // Maximum object area
-        oat::config::getValue(this_config, "max_area", max_object_area_, 0.0);
+        // Additional targets, each published to its own position SINK
+        oat::config::Table targets;
+        if (oat::config::getTable(this_config, "targets", targets)) {
 
-        // HSV thresholds
-        oat::config::Table t;
-        if (oat::config::getTable(this_config, "h_thresholds", t)) {
+            std::vector<std::string> target_options {"sink",
+                                                     "min_area",
+                                                     "max_area",
+                                                     "h_thresholds",
+                                                     "s_thresholds",
+                                                     "v_thresholds"};
 
-            int64_t val;
-            oat::config::getValue(t, "min", val, (int64_t)0, (int64_t)256, true);
-            h_min_ = val;
-            oat::config::getValue(t, "max", val, (int64_t)0, (int64_t)256, true);
-            h_max_ = val;
-        }
+            for (auto it = targets->begin(); it != targets->end(); it++) {
 
-        if (oat::config::getTable(this_config, "s_thresholds", t)) {
+                oat::config::Table target_config;
+                oat::config::getTable(targets, it->first, target_config);
+                oat::config::checkKeys(target_options, target_config);
 
-            int64_t val;
-            oat::config::getValue(t, "min", val, (int64_t)0, (int64_t)256, true);
-            s_min_ = val;
-            oat::config::getValue(t, "max", val, (int64_t)0, (int64_t)256, true);
-            s_max_ = val;
-        }
+                // Area limits default to those of the first target
+                Target target;
+                target.min_area = targets_[0].min_area;
+                target.max_area = targets_[0].max_area;
+                configureTarget(target_config, target);
 
-        if (oat::config::getTable(this_config, "v_thresholds", t)) {
+                std::string sink;
+                oat::config::getValue(target_config, "sink", sink, true);
+                addPositionSink(sink);
 
-            int64_t val;
-            oat::config::getValue(t, "min", val, (int64_t)0, (int64_t)256, true);
-            v_min_ = val;
-            oat::config::getValue(t, "max", val, (int64_t)0, (int64_t)256, true);
-            v_max_ = val;
+                targets_.push_back(target);
+            }
         }
 
+        // Frames are already HSV (e.g. from framefilt convert)
+        oat::config::getValue(this_config, "hsv_input", hsv_input_);
+
+        // Fused thresholding of BGR frames using a color lookup table
+        oat::config::getValue(this_config, "color_lut", color_lut_on_);
+
+        // Publish every blob passing the area limits as a position list
+        std::string blob_sink;
+        if (oat::config::getValue(this_config, "blob_sink", blob_sink))
+            setPositionListSink(blob_sink);
+
+        // Search only around the last positions
+        oat::config::Table window;
+        if (oat::config::getTable(this_config, "window", window))
+            configureTrackingWindow(window);
+
         // Tuning
         oat::config::getValue(this_config, "tune", tuning_on_);
 
@@ -166,6 +279,87 @@ void HSVDetector::configure(const std::string &config_file,
     }
 }
 
+void HSVDetector::configureTarget(const oat::config::Table &table,
+                                  Target &target) {
+
+    // Minimum object area
+    oat::config::getValue(table, "min_area", target.min_area, 0.0);
+
+    // Maximum object area
+    oat::config::getValue(table, "max_area", target.max_area, 0.0);
+
+    // HSV thresholds
+    oat::config::Table t;
+    if (oat::config::getTable(table, "h_thresholds", t)) {
+
+        int64_t val;
+        oat::config::getValue(t, "min", val, (int64_t)0, (int64_t)256, true);
+        target.h_min = val;
+        oat::config::getValue(t, "max", val, (int64_t)0, (int64_t)256, true);
+        target.h_max = val;
+    }
+
+    if (oat::config::getTable(table, "s_thresholds", t)) {
+
+        int64_t val;
+        oat::config::getValue(t, "min", val, (int64_t)0, (int64_t)256, true);
+        target.s_min = val;
+        oat::config::getValue(t, "max", val, (int64_t)0, (int64_t)256, true);
+        target.s_max = val;
+    }
+
+    if (oat::config::getTable(table, "v_thresholds", t)) {
+
+        int64_t val;
+        oat::config::getValue(t, "min", val, (int64_t)0, (int64_t)256, true);
+        target.v_min = val;
+        oat::config::getValue(t, "max", val, (int64_t)0, (int64_t)256, true);
+        target.v_max = val;
+    }
+}
+
+bool HSVDetector::Target::colorLUTStale() const {
+
+    return color_lut.empty()
+           || lut_thresholds != std::array<int, 6> {{h_min, h_max,
+                                                     s_min, s_max,
+                                                     v_min, v_max}};
+}
+
+void HSVDetector::Target::buildColorLUT() {
+
+    // Each plane of constant blue holds every green (row) and red (column)
+    // combination. Planes are converted and thresholded exactly as frames
+    // are by the unfused path, so both give identical results.
+    cv::Mat plane(256, 256, CV_8UC3), hsv_plane, plane_threshold;
+    for (int g = 0; g < 256; g++) {
+        auto *p = plane.ptr<cv::Vec3b>(g);
+        for (int r = 0; r < 256; r++)
+            p[r] = cv::Vec3b(0, g, r);
+    }
+
+    const int plane_bytes = 256 * oat::packedCols(256);
+    color_lut.resize(256 * plane_bytes);
+
+    for (int b = 0; b < 256; b++) {
+
+        plane.reshape(1, 256 * 256).col(0).setTo(b);
+
+        cv::cvtColor(plane, hsv_plane, cv::COLOR_BGR2HSV);
+        cv::inRange(hsv_plane,
+                    cv::Scalar(h_min, s_min, v_min),
+                    cv::Scalar(h_max, s_max, v_max),
+                    plane_threshold);
+
+        // Packed bit order matches the lookup index's low byte (red)
+        cv::Mat lut_plane(256, oat::packedCols(256), CV_8UC1,
+                          color_lut.data() + b * plane_bytes);
+        oat::packMask(plane_threshold, lut_plane);
+    }
+
+    lut_thresholds = {{h_min, h_max, s_min, s_max, v_min, v_max}};
+}
+
 void HSVDetector::tune(cv::Mat &frame, const oat::Position2D &position) {
 
     if (!tuning_windows_created_)
@@ -175,7 +369,7 @@ void HSVDetector::tune(cv::Mat &frame, const oat::Position2D &position) {
 
     // Plot a circle representing found object
     if (position.position_valid) {
-        auto radius = std::sqrt(object_area_ / PI);
+        auto radius = std::sqrt(targets_[0].object_area / PI);
         cv::Point center;
         center.x = position.position.x;
         center.y = position.position.y;
@@ -211,12 +405,12 @@ void HSVDetector::createTuningWindows() {
 #endif
 
     // Create sliders and insert them into window
-    cv::createTrackbar("H MIN", tuning_image_title_, &h_min_, 256);
-    cv::createTrackbar("H MAX", tuning_image_title_, &h_max_, 256);
-    cv::createTrackbar("S MIN", tuning_image_title_, &s_min_, 256);
-    cv::createTrackbar("S MAX", tuning_image_title_, &s_max_, 256);
-    cv::createTrackbar("V MIN", tuning_image_title_, &v_min_, 256);
-    cv::createTrackbar("V MAX", tuning_image_title_, &v_max_, 256);
+    cv::createTrackbar("H MIN", tuning_image_title_, &targets_[0].h_min, 256);
+    cv::createTrackbar("H MAX", tuning_image_title_, &targets_[0].h_max, 256);
+    cv::createTrackbar("S MIN", tuning_image_title_, &targets_[0].s_min, 256);
+    cv::createTrackbar("S MAX", tuning_image_title_, &targets_[0].s_max, 256);
+    cv::createTrackbar("V MIN", tuning_image_title_, &targets_[0].v_min, 256);
+    cv::createTrackbar("V MAX", tuning_image_title_, &targets_[0].v_max, 256);
     cv::createTrackbar("MIN AREA", tuning_image_title_, &dummy0_, 10000,
             &hsvDetectorMinAreaSliderChangedCallback, this);
     cv::createTrackbar("MAX AREA", tuning_image_title_, &dummy1_, 10000,
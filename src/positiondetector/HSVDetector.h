@@ -22,8 +22,12 @@
 
 #include "OatConfig.h" // Generated by CMake
 
+#include <array>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <limits>
+#include <vector>
 #include <opencv2/core/mat.hpp>
 #ifdef NOIMP_OAT_USE_CUDA
 #include <opencv2/cudaarithm.hpp>
@@ -31,6 +35,10 @@
 #include <opencv2/cudaimgproc.hpp>
 #endif
 
+#include "../../lib/utility/BandPool.h"
+#include "../../lib/utility/OatTOMLSanitize.h"
+
+#include "DetectorFunc.h"
 #include "PositionDetector.h"
 
 namespace oat {
@@ -38,7 +46,9 @@ namespace oat {
 class Position2D;
 
 /**
- * A color-based object position detector
+ * A color-based object position detector. Several color targets, each
+ * published to its own position SINK, can be detected in one pass over the
+ * frame.
  */
 class HSVDetector : public PositionDetector {
 public:
@@ -64,28 +74,77 @@ public:
     // Accessors (used for tuning GUI)
     void set_erode_size(int erode_px);
     void set_dilate_size(int dilate_px);
-    void set_min_object_area(double value) { min_object_area_ = value; }
-    void set_max_object_area(double value) { max_object_area_ = value; }
+    void set_min_object_area(double value) { targets_[0].min_area = value; }
+    void set_max_object_area(double value) { targets_[0].max_area = value; }
 
 private:
 
+    /**
+     * Threshold the frame for every target in a single pass and detect the
+     * position of each target in parallel.
+     * @param Frame to look for objects within.
+     * @param positions Detected object positions, one per target.
+     */
+    void detectPositions(cv::Mat &frame,
+                         std::vector<oat::Position2D> &positions) override;
+
+    double objectArea(const size_t index) const override {
+        return targets_[index].object_area;
+    }
+
+    // A color target and the position SINK it is published to. Target 0
+    // is configured by the top level thresholds and published to the
+    // position SINK given on the command line.
+    struct Target {
+
+        // HSV threshold values
+        int h_min {0}, h_max {256};
+        int s_min {0}, s_max {256};
+        int v_min {0}, v_max {256};
+
+        // Detect object area
+        double object_area {0.0};
+        double min_area {0.0};
+        double max_area {std::numeric_limits<double>::max()};
+
+        cv::Mat threshold_frame;
+        oat::BlobSifter blobs;
+
+        // One bit per 24-bit BGR color (2 MiB), set if the color's HSV value
+        // passes the thresholds. Rebuilt when the thresholds change, e.g.
+        // from the tuning GUI.
+        std::vector<uint8_t> color_lut;
+        std::array<int, 6> lut_thresholds;
+        bool colorLUTStale(void) const;
+        void buildColorLUT(void);
+    };
+
+    std::vector<Target> targets_;
+    void configureTarget(const oat::config::Table &table, Target &target);
+
     // Sizes of the erode and dilate blocks
     int erode_px_ {0}, dilate_px_ {10};
     bool erode_on_ {false}, dilate_on_ {false};
 
     // Internal matricies
-    cv::Mat threshold_frame_, erode_element_, dilate_element_;
+    cv::Mat erode_element_, dilate_element_;
 
-    // HSV threshold values
-    int h_min_ {0}, h_max_ {256};
-    int s_min_ {0}, s_max_ {256};
-    int v_min_ {0}, v_max_ {256};
+    // Tuning GUI slider positions
     int dummy0_ {0}, dummy1_ {10000};
 
-    // Detect object area
-    double object_area_ {0.0};
-    double min_object_area_ {0.0};
-    double max_object_area_ {std::numeric_limits<double>::max()};
+    // If true, SOURCE frames are already in HSV color space
+    bool hsv_input_ {false};
+
+    // Threshold BGR frames in a single pass using each target's color
+    // lookup table rather than converting to HSV and thresholding
+    bool color_lut_on_ {true};
+
+    // Find the position of a target in its threshold frame
+    void detectTarget(cv::Mat &frame, const size_t index,
+                      oat::Position2D &position);
+
+    // Targets are detected in parallel
+    std::unique_ptr<oat::BandPool> target_pool_;
 
     // Parameter tuning GUI functions and properties
     const std::string tuning_image_title_;
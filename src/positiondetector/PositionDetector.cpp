@@ -17,10 +17,14 @@
 //* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
 //******************************************************************************
 
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
 #include <string>
 #include <opencv2/core/mat.hpp>
 
 #include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/PositionList2D.h"
 #include "../../lib/shmemdf/Source.h"
 #include "../../lib/shmemdf/Sink.h"
 #include "../../lib/shmemdf/SharedFrameHeader.h"
@@ -33,11 +37,29 @@ PositionDetector::PositionDetector(const std::string &frame_source_address,
                                    const std::string &position_sink_address) :
   name_("posidet[" + frame_source_address + "->" + position_sink_address + "]")
 , frame_source_address_(frame_source_address)
-, position_sink_address_(position_sink_address)
+, position_sink_addresses_ {position_sink_address}
 {
   // Nothing
 }
 
+void PositionDetector::addPositionSink(const std::string &position_sink_address) {
+
+    if (!position_sinks_.empty())
+        throw (std::runtime_error("Position SINKs must be added before "
+                                  "connecting to nodes."));
+
+    position_sink_addresses_.push_back(position_sink_address);
+}
+
+void PositionDetector::setPositionListSink(const std::string &position_list_sink_address) {
+
+    if (!position_sinks_.empty())
+        throw (std::runtime_error("Position SINKs must be added before "
+                                  "connecting to nodes."));
+
+    position_list_sink_address_ = position_list_sink_address;
+}
+
 void PositionDetector::connectToNode() {
 
     // Establish our a slot in the node
@@ -46,9 +68,105 @@ void PositionDetector::connectToNode() {
     // Wait for synchronous start with sink when it binds the node
     frame_source_.connect();
 
-    // Bind to sink node and create a shared position
-    position_sink_.bind(position_sink_address_, position_sink_address_);
-    shared_position_ = position_sink_.retrieve();
+    // Mapping of SOURCE frames to the full sensor frame
+    frame_offset_ = oat::Point2D(frame_source_.parameters().offset_x,
+                                 frame_source_.parameters().offset_y);
+    frame_scale_ = oat::Point2D(frame_source_.parameters().scale_x,
+                                frame_source_.parameters().scale_y);
+
+    // Bind to sink nodes and create shared positions
+    for (auto &addr : position_sink_addresses_) {
+
+        position_sinks_.emplace_back(new oat::Sink<oat::Position2D>());
+        position_sinks_.back()->bind(addr, addr);
+        shared_positions_.push_back(position_sinks_.back()->retrieve());
+        internal_positions_.emplace_back("internal");
+    }
+
+    tracks_.resize(internal_positions_.size());
+
+    if (!position_list_sink_address_.empty()) {
+        position_list_sink_.bind(position_list_sink_address_,
+                                 position_list_sink_address_);
+        shared_position_list_ = position_list_sink_.retrieve();
+    }
+}
+
+void PositionDetector::configureTrackingWindow(const oat::config::Table &table) {
+
+    std::vector<std::string> options {"margin", "velocity_gain", "misses"};
+    oat::config::checkKeys(options, table);
+
+    int64_t val;
+    if (oat::config::getValue(table, "margin", val, (int64_t)0))
+        window_margin_ = val;
+
+    oat::config::getValue(table, "velocity_gain", window_velocity_gain_, 0.0);
+
+    if (oat::config::getValue(table, "misses", val, (int64_t)0))
+        max_misses_ = val;
+
+    window_on_ = true;
+}
+
+cv::Rect PositionDetector::trackingWindow(const cv::Size &frame_size) const {
+
+    const cv::Rect frame_rect(cv::Point(0, 0), frame_size);
+
+    // The whole frame is searched while tuning and until every position
+    // is being tracked
+    if (!window_on_ || tuning_on_)
+        return frame_rect;
+
+    cv::Rect window;
+    for (auto &t : tracks_) {
+
+        if (!t.valid)
+            return frame_rect;
+
+        const double steps = t.misses + 1;
+        const cv::Point2d predicted = t.last + t.velocity * steps;
+        const double half = (window_margin_
+                             + window_velocity_gain_ * cv::norm(t.velocity)
+                             + t.radius) * steps;
+
+        const cv::Rect r(cv::Point(std::floor(predicted.x - half),
+                                   std::floor(predicted.y - half)),
+                         cv::Point(std::ceil(predicted.x + half),
+                                   std::ceil(predicted.y + half)));
+
+        window = window.area() > 0 ? window | r : r;
+    }
+
+    window &= frame_rect;
+    return window.area() > 0 ? window : frame_rect;
+}
+
+void PositionDetector::updateTracks(std::vector<oat::Position2D> &positions) {
+
+    for (size_t i = 0; i < positions.size(); i++) {
+
+        auto &p = positions[i];
+        auto &t = tracks_[i];
+
+        if (p.position_valid) {
+
+            // Positions are relative to the search window
+            p.position.x += search_window_.x;
+            p.position.y += search_window_.y;
+
+            const cv::Point2d pos(p.position.x, p.position.y);
+            t.velocity = t.valid ? (pos - t.last) * (1.0 / (t.misses + 1))
+                                 : cv::Point2d(0, 0);
+            t.last = pos;
+            t.radius = std::sqrt(objectArea(i) / CV_PI);
+            t.misses = 0;
+            t.valid = true;
+
+        } else if (t.valid && ++t.misses > max_misses_) {
+            t.valid = false;
+        }
+    }
 }
 
 bool PositionDetector::process() {
@@ -69,23 +187,68 @@ bool PositionDetector::process() {
     ////////////////////////////
     //  END CRITICAL SECTION  //
 
-    // Propagate sample info and detect position
-    internal_position_.sample() = internal_frame_.sample_copy();
-    detectPosition(internal_frame_, internal_position_);
+    // Propagate sample info and detect positions
+    for (auto &p : internal_positions_)
+        p.sample() = internal_frame_.sample_copy();
+    internal_position_list_.sample() = internal_frame_.sample_copy();
+    internal_position_list_.clear();
 
-    // START CRITICAL SECTION //
-    ////////////////////////////
+    search_window_ = trackingWindow(internal_frame_.size());
+    detectPositions(internal_frame_, internal_positions_);
+    updateTracks(internal_positions_);
 
-    // Wait for sources to read
-    position_sink_.wait();
+    for (size_t i = 0; i < position_sinks_.size(); i++) {
 
-    *shared_position_ = internal_position_;
+        auto &position = internal_positions_[i];
 
-    // Tell sources there is new data
-    position_sink_.post();
+        // Map positions in cropped or resized frames back to the full
+        // sensor frame
+        if (position.position_valid) {
+            position.position.x = frame_offset_.x
+                                  + frame_scale_.x * position.position.x;
+            position.position.y = frame_offset_.y
+                                  + frame_scale_.y * position.position.y;
+        }
 
-    ////////////////////////////
-    //  END CRITICAL SECTION  //
+        // START CRITICAL SECTION //
+        ////////////////////////////
+
+        // Wait for sources to read
+        position_sinks_[i]->wait();
+
+        *shared_positions_[i] = position;
+
+        // Tell sources there is new data
+        position_sinks_[i]->post();
+
+        ////////////////////////////
+        //  END CRITICAL SECTION  //
+    }
+
+    if (shared_position_list_ != nullptr) {
+
+        // Map positions back to the full sensor frame
+        for (auto &p : internal_position_list_) {
+            p.position.x = frame_offset_.x
+                           + frame_scale_.x * (p.position.x + search_window_.x);
+            p.position.y = frame_offset_.y
+                           + frame_scale_.y * (p.position.y + search_window_.y);
+        }
+
+        // START CRITICAL SECTION //
+        ////////////////////////////
+
+        // Wait for sources to read
+        position_list_sink_.wait();
+
+        *shared_position_list_ = internal_position_list_;
+
+        // Tell sources there is new data
+        position_list_sink_.post();
+
+        ////////////////////////////
+        //  END CRITICAL SECTION  //
+    }
 
     // Sink was not at END state
     return false;
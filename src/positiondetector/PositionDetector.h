@@ -20,12 +20,16 @@
 #ifndef OAT_POSITIONDETECTOR_H
 #define	OAT_POSITIONDETECTOR_H
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "../../lib/datatypes/Frame.h"
 #include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/PositionList2D.h"
 #include "../../lib/shmemdf/Source.h"
 #include "../../lib/shmemdf/Sink.h"
+#include "../../lib/utility/OatTOMLSanitize.h"
 
 namespace oat {
 
@@ -83,7 +87,64 @@ protected:
      * @param position Detected object position.
      */
     virtual void detectPosition(cv::Mat &frame, oat::Position2D &position) = 0;
-    
+
+    /**
+     * Perform position detection for every position SINK. Detectors that
+     * publish several positions (see addPositionSink()) override this. By
+     * default, detectPosition() is called for the only position.
+     * @param Frame to look for objects within.
+     * @param positions Detected object positions, one per position SINK.
+     */
+    virtual void detectPositions(cv::Mat &frame,
+                                 std::vector<oat::Position2D> &positions) {
+        detectPosition(frame, positions[0]);
+    }
+
+    /**
+     * Add a position SINK in addition to the one given at construction.
+     * Must be called before connectToNode().
+     * @param position_sink_address Position SINK node address
+     */
+    void addPositionSink(const std::string &position_sink_address);
+
+    /**
+     * Publish every object found for the first position SINK, not only the
+     * largest, to a position list SINK. Must be called before
+     * connectToNode().
+     * @param position_list_sink_address Position list SINK node address
+     */
+    void setPositionListSink(const std::string &position_list_sink_address);
+
+    /**
+     * List for detectors to fill with every object found for the first
+     * position SINK, relative to the search window like positions.
+     * @return Position list, or nullptr if there is no position list SINK.
+     */
+    oat::PositionList2D * positionList(void) {
+        return position_list_sink_address_.empty() ? nullptr
+                                                   : &internal_position_list_;
+    }
+
+    /**
+     * Area of the object found by the last detection, which sizes the
+     * tracking window.
+     * @param index Position index
+     * @return Object area (pixels^2). Zero if unknown.
+     */
+    virtual double objectArea(const size_t) const { return 0.0; }
+
+    /**
+     * Enable the tracking window using a configuration table holding the
+     * optional keys margin, velocity_gain and misses.
+     * @param table Tracking window configuration
+     */
+    void configureTrackingWindow(const oat::config::Table &table);
+
+    // Region of the frame to search. Detectors restrict their search to it
+    // and report positions relative to its upper left corner. This is the
+    // whole frame unless the tracking window is enabled.
+    cv::Rect search_window_;
+
     // Detector name
     const std::string name_;
 
@@ -95,16 +156,49 @@ private:
 
     // Current frame
     oat::Frame internal_frame_;
-    oat::Position2D internal_position_ {"internal"};
-    oat::Position2D * shared_position_;
+    std::vector<oat::Position2D> internal_positions_;
 
     // Frame source
     const std::string frame_source_address_;
     oat::Source<oat::SharedFrameHeader> frame_source_;
 
-    // Position sink
-    const std::string position_sink_address_;
-    oat::Sink<oat::Position2D> position_sink_;
+    // Upper left pixel of SOURCE frames within the full sensor frame, and
+    // the size of their pixels in full frame pixels, for cropped or resized
+    // frames
+    oat::Point2D frame_offset_;
+    oat::Point2D frame_scale_ {1.0, 1.0};
+
+    // Tracking window. Once every position has been found, only a window
+    // around each position predicted from its last velocity is searched.
+    // The window grows with speed, object size and consecutive misses. A
+    // position that is missed more than max_misses_ times in a row is
+    // searched for in the whole frame.
+    struct Track {
+        bool valid {false};
+        cv::Point2d last;
+        cv::Point2d velocity;
+        double radius {0.0};
+        int misses {0};
+    };
+
+    bool window_on_ {false};
+    int window_margin_ {32};
+    double window_velocity_gain_ {2.0};
+    int max_misses_ {5};
+    std::vector<Track> tracks_;
+    cv::Rect trackingWindow(const cv::Size &frame_size) const;
+    void updateTracks(std::vector<oat::Position2D> &positions);
+
+    // Position sinks
+    std::vector<std::string> position_sink_addresses_;
+    std::vector<std::unique_ptr<oat::Sink<oat::Position2D>>> position_sinks_;
+    std::vector<oat::Position2D *> shared_positions_;
+
+    // Position list sink
+    std::string position_list_sink_address_;
+    oat::Sink<oat::PositionList2D> position_list_sink_;
+    oat::PositionList2D * shared_position_list_ {nullptr};
+    oat::PositionList2D internal_position_list_ {"internal"};
 
 };
 
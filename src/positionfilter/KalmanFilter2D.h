@@ -86,6 +86,9 @@ private:
      */
     void filter(oat::Position2D& position) override;
 
+    // The filter state tracks a single object
+    bool filtersLists(void) const override { return false; }
+
     // TODO: These subroutines have pretty boring type signatures...
     void tune(void);
     void initializeFilter(void);
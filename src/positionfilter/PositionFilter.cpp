@@ -34,6 +34,19 @@ PositionFilter::PositionFilter(const std::string &position_source_address,
 
 void PositionFilter::connectToNode() {
 
+    if (list_on_) {
+
+        if (!filtersLists())
+            throw (std::runtime_error("This filter TYPE cannot filter "
+                                      "position lists."));
+
+        position_list_source_.touch(position_source_address_);
+        position_list_source_.connect();
+        position_list_sink_.bind(position_sink_address_, position_sink_address_);
+        shared_position_list_ = position_list_sink_.retrieve();
+        return;
+    }
+
     // Establish our a slot in the node 
     position_source_.touch(position_source_address_);
 
@@ -47,6 +60,9 @@ void PositionFilter::connectToNode() {
 
 bool PositionFilter::process() {
 
+    if (list_on_)
+        return processList();
+
     // START CRITICAL SECTION //
     ////////////////////////////
 
@@ -84,4 +100,46 @@ bool PositionFilter::process() {
     return false;
 }
 
+bool PositionFilter::processList() {
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sink to write to node
+    if (position_list_source_.wait() == oat::NodeState::END)
+        return true;
+
+    // Copy the listed positions
+    internal_position_list_ = *position_list_source_.retrieve();
+
+    // Tell sink it can continue
+    position_list_source_.post();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    // Positions share the list's sample
+    for (auto &p : internal_position_list_) {
+        p.sample() = internal_position_list_.sample();
+        filter(p);
+    }
+
+    // START CRITICAL SECTION //
+    ////////////////////////////
+
+    // Wait for sources to read
+    position_list_sink_.wait();
+
+    *shared_position_list_ = internal_position_list_;
+
+    // Tell sources there is new data
+    position_list_sink_.post();
+
+    ////////////////////////////
+    //  END CRITICAL SECTION  //
+
+    // Sink was not at END state
+    return false;
+}
+
 } /* namespace oat */
@@ -25,6 +25,7 @@
 #include "../../lib/shmemdf/Source.h"
 #include "../../lib/shmemdf/Sink.h"
 #include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/PositionList2D.h"
 
 namespace oat {
 
@@ -71,6 +72,13 @@ public:
     // Accessors
     std::string name(void) const { return name_; }
 
+    /**
+     * Filter position lists instead of single positions. Each position of a
+     * list is filtered in turn. Must be set before connectToNode().
+     * @param value If true, SOURCE and SINK carry position lists
+     */
+    void set_list_on(const bool value) { list_on_ = value; }
+
 protected:
 
     /**
@@ -79,6 +87,12 @@ protected:
      */
     virtual void filter(oat::Position2D &position) = 0;
 
+    /**
+     * Filters that keep state between positions assume one object and
+     * cannot filter position lists.
+     */
+    virtual bool filtersLists(void) const { return true; }
+
 private:
 
     // Filter name
@@ -97,6 +111,14 @@ private:
     // Position SINK
     const std::string position_sink_address_;
     oat::Sink<oat::Position2D> position_sink_;
+
+    // Position lists
+    bool list_on_ {false};
+    oat::Source<oat::PositionList2D> position_list_source_;
+    oat::PositionList2D internal_position_list_ {"internal"};
+    oat::PositionList2D * shared_position_list_;
+    oat::Sink<oat::PositionList2D> position_list_sink_;
+    bool processList(void);
 };
 
 }      /* namespace oat */
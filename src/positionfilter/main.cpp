@@ -93,6 +93,7 @@ int main(int argc, char *argv[]) {
     std::string sink;
     std::vector<std::string> config_fk;
     bool config_used = false;
+    bool list_on = false;
     po::options_description visible_options("OPTIONS");
 
     std::unordered_map<std::string, char> type_hash;
@@ -112,6 +113,8 @@ int main(int argc, char *argv[]) {
         config.add_options()
                 ("config,c", po::value<std::vector<std::string> >()->multitoken(),
                 "Configuration file/key pair.")
+                ("list,l", "SOURCE and SINK carry position lists, e.g. from "
+                "a detector's blob_sink. Every position in a list is filtered.")
                 ;
 
         po::options_description hidden("HIDDEN OPTIONS");
@@ -185,6 +188,9 @@ int main(int argc, char *argv[]) {
             return -1;
         }
 
+        if (variable_map.count("list"))
+            list_on = true;
+
         if (!variable_map["config"].empty()) {
 
             config_fk = variable_map["config"].as<std::vector<std::string> >();
@@ -234,6 +240,8 @@ int main(int argc, char *argv[]) {
         }
     }
         
+    filter->set_list_on(list_on);
+
     try {
 
         if (config_used)
@@ -29,6 +29,7 @@ namespace oat {
 
 // Forward decl.
 class Position2D;
+class PositionList2D;
 
 class PositionPublisher : public PositionSocket {
 
@@ -45,6 +46,11 @@ private:
     zmq::socket_t publisher_;
 
     void sendPosition(const oat::Position2D& position) override;
+    void sendPositions(const oat::PositionList2D& positions) override;
+
+    // Serialize and send a position or position list
+    template <typename T>
+    void send(const T& position);
 };
 
 }      /* namespace oat */
@@ -23,6 +23,7 @@
 #include <rapidjson/stringbuffer.h>
 
 #include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/PositionList2D.h"
 #include "../../lib/shmemdf/Source.h"
 #include "../../lib/shmemdf/Sink.h"
 
@@ -39,6 +40,15 @@ PositionReplier::PositionReplier(const std::string &position_source_address,
 }
 
 void PositionReplier::sendPosition(const oat::Position2D& position) {
+    send(position);
+}
+
+void PositionReplier::sendPositions(const oat::PositionList2D& positions) {
+    send(positions);
+}
+
+template <typename T>
+void PositionReplier::send(const T& position) {
     
     // Serialize the current position
     rapidjson::StringBuffer buffer;
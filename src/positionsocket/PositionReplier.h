@@ -29,6 +29,7 @@ namespace oat {
 
 // Forward decl.
 class Position2D;
+class PositionList2D;
 
 class PositionReplier : public PositionSocket {
 public:
@@ -44,6 +45,11 @@ private:
     zmq::socket_t replier_;
 
     void sendPosition(const oat::Position2D& position) override;
+    void sendPositions(const oat::PositionList2D& positions) override;
+
+    // Serialize and send a position or position list
+    template <typename T>
+    void send(const T& position);
 };
 
 }      /* namespace oat */
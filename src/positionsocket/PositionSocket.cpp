@@ -20,6 +20,7 @@
 #include <string>
 
 #include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/PositionList2D.h"
 #include "../../lib/shmemdf/Source.h"
 #include "../../lib/shmemdf/Sink.h"
 
@@ -36,6 +37,12 @@ PositionSocket::PositionSocket(const std::string &position_source_address) :
 
 void PositionSocket::connectToNode() {
 
+    if (list_on_) {
+        position_list_source_.touch(position_source_address_);
+        position_list_source_.connect();
+        return;
+    }
+
     // Establish our a slot in the node 
     position_source_.touch(position_source_address_);
 
@@ -45,6 +52,27 @@ void PositionSocket::connectToNode() {
 
 bool PositionSocket::process() {
 
+    if (list_on_) {
+
+         // START CRITICAL SECTION //
+        ////////////////////////////
+        node_state_ = position_list_source_.wait();
+        if (node_state_ == oat::NodeState::END)
+            return true;
+
+        // Copy the listed positions
+        internal_position_list_ = *position_list_source_.retrieve();
+
+        // Tell sink it can continue
+        position_list_source_.post();
+
+        ////////////////////////////
+        //  END CRITICAL SECTION  //
+
+        sendPositions(internal_position_list_);
+        return false;
+    }
+
      // START CRITICAL SECTION //
     ////////////////////////////
     node_state_ = position_source_.wait();
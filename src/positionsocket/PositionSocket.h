@@ -25,6 +25,7 @@
 #include <boost/asio.hpp>
 
 #include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/PositionList2D.h"
 #include "../../lib/shmemdf/Source.h"
 #include "../../lib/shmemdf/Sink.h"
 
@@ -57,6 +58,13 @@ public:
     // Accessors
     std::string name(void) const { return name_; }
 
+    /**
+     * Serve position lists instead of single positions. Must be set before
+     * connectToNode().
+     * @param value If true, SOURCE carries position lists
+     */
+    void set_list_on(const bool value) { list_on_ = value; }
+
 protected:
 
     /**
@@ -65,6 +73,12 @@ protected:
      */
     virtual void sendPosition(const oat::Position2D &position) = 0;
 
+    /**
+     * Serve a position list via specified IO protocol.
+     * @param Position list to serve.
+     */
+    virtual void sendPositions(const oat::PositionList2D &positions) = 0;
+
 private:
 
     // Position Socket name
@@ -77,6 +91,11 @@ private:
 
     // The current, internally allocated position
     oat::Position2D internal_position_ {"internal"};
+
+    // Position lists
+    bool list_on_ {false};
+    oat::Source<oat::PositionList2D> position_list_source_;
+    oat::PositionList2D internal_position_list_ {"internal"};
 };
 
 }      /* namespace oat */
@@ -23,6 +23,7 @@
 #include <rapidjson/rapidjson.h>
 
 #include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/PositionList2D.h"
 
 #include "SocketWriteStream.h"
 #include "UDPPositionClient.h"
@@ -45,7 +46,16 @@ UDPPositionClient::UDPPositionClient(const std::string &position_source_address,
 }
 
 // Each position is sent in a single UDP packet
-void UDPPositionClient::sendPosition(const oat::Position2D& current_position) {
+void UDPPositionClient::sendPosition(const oat::Position2D& position) {
+    send(position);
+}
+
+void UDPPositionClient::sendPositions(const oat::PositionList2D& positions) {
+    send(positions);
+}
+
+template <typename T>
+void UDPPositionClient::send(const T& current_position) {
 
     rapidjson::Writer < rapidjson::SocketWriteStream
                       < UDPSocket, UDPEndpoint > > udp_writer_ {*udp_stream_};
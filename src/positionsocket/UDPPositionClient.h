@@ -32,6 +32,7 @@ namespace oat {
 
 // Forward decl.
 class Position2D;
+class PositionList2D;
 
 class UDPPositionClient : public PositionSocket {
 
@@ -59,6 +60,11 @@ private:
     std::unique_ptr<SocketWriter> udp_stream_;
 
     void sendPosition(const oat::Position2D& position) override;
+    void sendPositions(const oat::PositionList2D& positions) override;
+
+    // Serialize and send a position or position list
+    template <typename T>
+    void send(const T& position);
 };
 
 }      /* namespace oat */
@@ -24,6 +24,7 @@
 #include <rapidjson/rapidjson.h>
 
 #include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/PositionList2D.h"
 
 #include "SocketWriteStream.h"
 #include "UDPPositionServer.h"
@@ -43,7 +44,16 @@ UDPPositionServer::UDPPositionServer(const std::string &position_source_address,
 
 }
 
-void UDPPositionServer::sendPosition(const oat::Position2D& current_position) {
+void UDPPositionServer::sendPosition(const oat::Position2D& position) {
+    send(position);
+}
+
+void UDPPositionServer::sendPositions(const oat::PositionList2D& positions) {
+    send(positions);
+}
+
+template <typename T>
+void UDPPositionServer::send(const T& current_position) {
 
     rapidjson::Writer < rapidjson::SocketWriteStream
                       < UDPSocket, UDPEndpoint > > udp_writer_ {*udp_stream_};
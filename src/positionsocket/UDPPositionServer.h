@@ -32,6 +32,7 @@ namespace oat {
 
 // Forward decl.
 class Position2D;
+class PositionList2D;
 
 class UDPPositionServer : public PositionSocket {
 
@@ -75,6 +76,11 @@ private:
      * @param sample
      */
     void sendPosition(const oat::Position2D& position) override;
+    void sendPositions(const oat::PositionList2D& positions) override;
+
+    // Serialize and send a position or position list
+    template <typename T>
+    void send(const T& position);
 
 };
 
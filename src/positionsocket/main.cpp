@@ -95,6 +95,7 @@ int main(int argc, char *argv[]) {
     std::string source;
     std::vector<std::string> endpoint;
 //    bool server_side = false;
+    bool list_on = false;
     po::options_description visible_options("OPTIONS");
 
     std::unordered_map<std::string, char> type_hash;
@@ -118,6 +119,12 @@ int main(int argc, char *argv[]) {
                 //TODO: Serialization protocol (JSON, binary, etc)
                 ;
 
+        po::options_description config("CONFIGURATION");
+        config.add_options()
+                ("list,l", "SOURCE carries position lists, e.g. from a "
+                "detector's blob_sink. Each list is sent as a single packet.")
+                ;
+
         po::options_description hidden("HIDDEN OPTIONS");
         hidden.add_options()
                 ("type", po::value<std::string>(&type), "Filter TYPE.")
@@ -133,10 +140,10 @@ int main(int argc, char *argv[]) {
         positional_options.add("positionsource", 1);
         positional_options.add("endpoint", -1);
 
-        visible_options.add(options);
+        visible_options.add(options).add(config);
 
         po::options_description all_options("ALL OPTIONS");
-        all_options.add(options).add(hidden);
+        all_options.add(options).add(config).add(hidden);
 
         po::variables_map variable_map;
         po::store(po::command_line_parser(argc, argv)
@@ -175,6 +182,9 @@ int main(int argc, char *argv[]) {
             return -1;
         }
 
+        if (variable_map.count("list"))
+            list_on = true;
+
         if (!variable_map["endpoint"].empty()) {
 
             endpoint = variable_map["endpoint"].as<std::vector<std::string> >();
@@ -243,6 +253,8 @@ int main(int argc, char *argv[]) {
             }
         }
 
+        socket->set_list_on(list_on);
+
         // Tell user
         std::cout << oat::whoMessage(socket->name(),
                 "Listening to source " + oat::sourceText(source) + ".\n")
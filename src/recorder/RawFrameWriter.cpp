@@ -0,0 +1,89 @@
+//******************************************************************************
+//* File:   RawFrameWriter.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "RawFrameWriter.h"
+
+namespace oat {
+
+// Large stdio buffer so that each frame results in few write syscalls
+static constexpr size_t RAW_WRITE_BUFFER_SIZE {1 << 22};
+
+RawFrameWriter::~RawFrameWriter() {
+
+    if (fp_ != nullptr)
+        fclose(fp_);
+}
+
+bool RawFrameWriter::open(const std::string &file_name,
+                          const cv::Mat &example,
+                          const double period_sec) {
+
+    fp_ = fopen(file_name.c_str(), "wb");
+    if (fp_ == nullptr)
+        return false;
+
+    setvbuf(fp_, nullptr, _IOFBF, RAW_WRITE_BUFFER_SIZE);
+
+    header_.rows = example.rows;
+    header_.cols = example.cols;
+    header_.type = example.type();
+    header_.frame_bytes = example.total() * example.elemSize();
+    header_.record_bytes = oat::raw::recordBytes(header_.frame_bytes);
+    header_.period_sec = period_sec;
+
+    padding_.assign(header_.record_bytes - sizeof(oat::raw::FrameRecord)
+                    - header_.frame_bytes, 0);
+
+    if (fwrite(&header_, sizeof(header_), 1, fp_) != 1) {
+        fclose(fp_);
+        fp_ = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+bool RawFrameWriter::write(const oat::Sample &sample, const cv::Mat &frame) {
+
+    if (fp_ == nullptr
+        || frame.total() * frame.elemSize() != header_.frame_bytes)
+        return false;
+
+    oat::raw::FrameRecord record;
+    record.count = sample.count();
+    record.microseconds = sample.microseconds().count();
+    record.dropped = sample.dropped();
+
+    bool ok = fwrite(&record, sizeof(record), 1, fp_) == 1;
+
+    if (frame.isContinuous()) {
+        ok &= fwrite(frame.data, header_.frame_bytes, 1, fp_) == 1;
+    } else {
+        const size_t row_bytes = frame.cols * frame.elemSize();
+        for (int i = 0; i < frame.rows; i++)
+            ok &= fwrite(frame.ptr(i), row_bytes, 1, fp_) == 1;
+    }
+
+    if (!padding_.empty())
+        ok &= fwrite(padding_.data(), padding_.size(), 1, fp_) == 1;
+
+    return ok;
+}
+
+} /* namespace oat */
@@ -0,0 +1,78 @@
+//******************************************************************************
+//* File:   RawFrameWriter.h
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#ifndef OAT_RAWFRAMEWRITER_H
+#define OAT_RAWFRAMEWRITER_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "../../lib/datatypes/Sample.h"
+#include "../../lib/utility/RawFrameFormat.h"
+
+namespace oat {
+
+/**
+ * Writes frames, uncompressed, to a raw frame container (see
+ * RawFrameFormat.h). Usage mirrors cv::VideoWriter.
+ */
+class RawFrameWriter {
+
+public:
+
+    RawFrameWriter() = default;
+    ~RawFrameWriter();
+
+    // Not copyable
+    RawFrameWriter(const RawFrameWriter &) = delete;
+    RawFrameWriter &operator=(const RawFrameWriter &) = delete;
+
+    /**
+     * Create the file and write its header.
+     * @param file_name Path of the file to create.
+     * @param example Frame with the geometry and type of all frames that will
+     * be written.
+     * @param period_sec Sample period of the recorded stream.
+     * @return false if the file could not be created.
+     */
+    bool open(const std::string &file_name,
+              const cv::Mat &example,
+              const double period_sec);
+
+    bool isOpened(void) const { return fp_ != nullptr; }
+
+    /**
+     * Append a frame and its sample information.
+     * @param sample Sample information of the frame.
+     * @param frame Frame to write. Must match the example passed to open().
+     * @return false if the write failed.
+     */
+    bool write(const oat::Sample &sample, const cv::Mat &frame);
+
+private:
+
+    FILE *fp_ {nullptr};
+    oat::raw::FileHeader header_;
+    std::vector<char> padding_;
+};
+
+}      /* namespace oat */
+#endif /* OAT_RAWFRAMEWRITER_H */
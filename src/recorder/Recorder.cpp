@@ -42,7 +42,10 @@
 namespace oat {
 
 Recorder::Recorder(const std::vector<std::string> &position_source_addresses,
-                   const std::vector<std::string> &frame_source_addresses)
+                   const std::vector<std::string> &frame_source_addresses,
+                   const bool raw_frames,
+                   const std::vector<std::string> &position_list_source_addresses) :
+  raw_frames_(raw_frames)
 {
     // Start recorder name construction
     name_ = "recorder[" ;
@@ -65,10 +68,30 @@ Recorder::Recorder(const std::vector<std::string> &position_source_addresses,
         }
     }
 
+    // Setup position list sources
+    if (!position_list_source_addresses.empty()) {
+
+        if (!position_source_addresses.empty())
+            name_ += ", ";
+
+        name_ += position_list_source_addresses[0];
+        if (position_list_source_addresses.size() > 1)
+            name_ += "..";
+
+        for (auto &addr : position_list_source_addresses) {
+
+            position_lists_.emplace_back(addr);
+            position_list_sources_.push_back(std::make_pair(addr,
+                    std::make_unique<oat::Source < oat::PositionList2D >> ())
+            );
+        }
+    }
+
     // Setup the frame sources
     if (!frame_source_addresses.empty()) {
 
-        if (!position_source_addresses.empty())
+        if (!position_source_addresses.empty()
+            || !position_list_source_addresses.empty())
             name_ += ", ";
 
         name_ += frame_source_addresses[0];
@@ -139,6 +162,10 @@ void Recorder::connectToNodes() {
     for (auto &ps : position_sources_)
         ps.second->touch(ps.first);
 
+    // Connect to position list source nodes
+    for (auto &ls : position_list_sources_)
+        ls.second->touch(ls.first);
+
     // Verify connections and check sample rates If sample rates are variable,
     // the user should be using multiple recorders instead of just one, which
     // enforces sample synchronization
@@ -171,6 +198,18 @@ void Recorder::connectToNodes() {
         }
     }
 
+    // Position list sources
+    for (auto &ls : position_list_sources_) {
+        ls.second->connect();
+        ts = ls.second->retrieve()->sample().period_sec();
+        if (ts_last != -1.0 && ts != ts_last) {
+            ts = ts > ts_last ? ts : ts_last;
+            ts_consistent = false;
+        } else {
+            ts_last = ts;
+        }
+    }
+
     sample_rate_hz_ = 1.0 / ts;
 
 #ifndef NDEBUG
@@ -198,7 +237,9 @@ bool Recorder::writeStreams() {
 
         // Push newest frame into client N's queue
         if (record_on_) {
-            if (!frame_write_buffers_[i]->push(frame_sources_[i].second->clone())) {
+            const auto &source = *frame_sources_[i].second;
+            if (!frame_write_buffers_[i]->push(
+                    SampledFrame(source.retrieve().sample_copy(), source.clone()))) {
                 throw (std::runtime_error("Frame buffer overrun. Decrease the frame "
                                           "rate or get a faster hard-disk."));
             }
@@ -227,6 +268,21 @@ bool Recorder::writeStreams() {
         //  END CRITICAL SECTION  //
     }
 
+    // Read position lists
+    for (psvec_size_t i = 0; i !=  position_list_sources_.size(); i++) {
+
+        // START CRITICAL SECTION //
+        ////////////////////////////
+        sources_eof |= position_list_sources_[i].second->wait() == oat::NodeState::END;
+
+        // Copies only the occupied part of the list
+        position_lists_[i] = *position_list_sources_[i].second->retrieve();
+
+        position_list_sources_[i].second->post();
+        ////////////////////////////
+        //  END CRITICAL SECTION  //
+    }
+
     // Push frames to buffers
     // Write the frames to file
     if (record_on_)
@@ -237,21 +293,50 @@ bool Recorder::writeStreams() {
 
 void Recorder::writeFramesToFileFromBuffer(uint32_t writer_idx) {
 
-    cv::Mat m;
+    SampledFrame f;
+    bool raw_failed = false;
     while (running_) {
 
         std::unique_lock<std::mutex> lk(*frame_write_mutexes_[writer_idx]);
         frame_write_condition_variables_[writer_idx]->wait_for(lk, std::chrono::milliseconds(10));
 
-        while (frame_write_buffers_[writer_idx]->pop(m)) {
+        while (frame_write_buffers_[writer_idx]->pop(f)) {
+
+            if (raw_frames_) {
+
+                // Frames are discarded once the file could not be created so
+                // that the queue keeps draining
+                if (raw_failed)
+                    continue;
+
+                // Initialize using the first frame taken from the SOURCE
+                auto &writer = *raw_writers_[writer_idx];
+                if (!writer.isOpened()
+                    && !writer.open(video_file_names_.at(writer_idx),
+                                    f.second,
+                                    1.0 / sample_rate_hz_)) {
+                    std::cerr << oat::Error("Failed to create "
+                                 + video_file_names_.at(writer_idx)
+                                 + ". Its frames will not be recorded.\n");
+                    raw_failed = true;
+                    continue;
+                }
+
+                if (!writer.write(f.first, f.second)) {
+                    std::cerr << oat::Error("Failed to write frame to "
+                                 + video_file_names_.at(writer_idx) + ".\n");
+                }
+
+                continue;
+            }
 
             if (!video_writers_[writer_idx]->isOpened()) {
                 initializeVideoWriter(*video_writers_[writer_idx],
                                       video_file_names_.at(writer_idx),
-                                      m);
+                                      f.second);
             }
 
-            video_writers_[writer_idx]->write(m);
+            video_writers_[writer_idx]->write(f.second);
         }
     }
 }
@@ -267,13 +352,19 @@ void Recorder::writePositionsToFile() {
             positions_[i].Serialize(json_writer_);
         }
 
+        for (auto &l : position_lists_) {
+            json_writer_.String(l.label());
+            l.Serialize(json_writer_);
+        }
+
         json_writer_.EndObject();
     }
 }
 
 void Recorder::writePositionFileHeader(const std::string& date,
                                        const double sample_rate,
-                                       const std::vector<std::string>& sources) {
+                                       const std::vector<std::string>& sources,
+                                       const std::vector<std::string>& list_sources) {
 
     json_writer_.StartObject();
 
@@ -289,6 +380,14 @@ void Recorder::writePositionFileHeader(const std::string& date,
         json_writer_.String(s.c_str());
     json_writer_.EndArray();
 
+    if (!list_sources.empty()) {
+        json_writer_.String("position_list_sources");
+        json_writer_.StartArray();
+        for (auto &s : list_sources)
+            json_writer_.String(s.c_str());
+        json_writer_.EndArray();
+    }
+
     json_writer_.EndObject();
 
 }
@@ -314,7 +413,7 @@ void Recorder::initializeRecording(const std::string &save_directory,
     // Generate timestamp for headers and potentially for file names
     std::string timestamp = oat::createTimeStamp();
 
-    if (!position_sources_.empty()) {
+    if (!position_sources_.empty() || !position_list_sources_.empty()) {
 
         // If there we are starting a new file, finish up the old one
         if (position_fp_ != nullptr) {
@@ -327,7 +426,8 @@ void Recorder::initializeRecording(const std::string &save_directory,
         std::string posi_fid;
         std::string base_fid;
         if (prepend_source)
-           base_fid = position_sources_[0].first;
+           base_fid = position_sources_.empty() ? position_list_sources_[0].first
+                                                : position_sources_[0].first;
         if (!file_name.empty() && base_fid.empty())
            base_fid = file_name;
         else if (!file_name.empty() && !base_fid.empty())
@@ -371,7 +471,11 @@ void Recorder::initializeRecording(const std::string &save_directory,
                        std::back_inserter(pos_addrs),
                        [](PositionSource& p){ return p.first; });
 
-        writePositionFileHeader(timestamp, sample_rate_hz_, pos_addrs);
+        std::vector<std::string> list_addrs;
+        for (auto &l : position_list_sources_)
+            list_addrs.push_back(l.first);
+
+        writePositionFileHeader(timestamp, sample_rate_hz_, pos_addrs, list_addrs);
 
         // Start data object
         json_writer_.String("positions");
@@ -396,7 +500,7 @@ void Recorder::initializeRecording(const std::string &save_directory,
                base_fid = file_name;
             else if (!file_name.empty() && !base_fid.empty())
                base_fid += "_" + file_name;
-            base_fid += ".avi";
+            base_fid += raw_frames_ ? ".raw" : ".avi";
 
             int err = oat::createSavePath(frame_fid,
                                           save_directory,
@@ -411,6 +515,7 @@ void Recorder::initializeRecording(const std::string &save_directory,
 
             video_file_names_.push_back(frame_fid);
             video_writers_.push_back(std::make_unique<cv::VideoWriter>());
+            raw_writers_.push_back(std::make_unique<oat::RawFrameWriter>());
         }
     }
 }
@@ -24,6 +24,7 @@
 #include <condition_variable>
 #include <string>
 #include <thread>
+#include <utility>
 #include <boost/dynamic_bitset.hpp>
 #include <boost/lockfree/spsc_queue.hpp>
 #include <opencv2/core.hpp>
@@ -35,6 +36,9 @@
 #include "../../lib/shmemdf/Sink.h"
 #include "../../lib/datatypes/Frame.h"
 #include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/PositionList2D.h"
+
+#include "RawFrameWriter.h"
 
 namespace oat {
 namespace blf = boost::lockfree;
@@ -63,10 +67,17 @@ public:
                                      < oat::Source
                                      < oat::Position2D > > >;
 
+    using PositionListSource = std::pair < std::string, std::unique_ptr
+                                         < oat::Source
+                                         < oat::PositionList2D > > >;
+
     using FrameSource = std::pair < std::string, std::unique_ptr
                                   < oat::Source<oat::SharedFrameHeader > > >;
 
-    using FrameQueue =  blf::spsc_queue < oat::Frame, boost::lockfree::capacity
+    // Frames are queued along with a copy of their sample information, which
+    // does not survive copying an oat::Frame
+    using SampledFrame = std::pair<oat::Sample, cv::Mat>;
+    using FrameQueue =  blf::spsc_queue < SampledFrame, boost::lockfree::capacity
                                         < FRAME_WRITE_BUFFER_SIZE > >;
 
     using psvec_size_t = std::vector<PositionSource>::size_type;
@@ -77,9 +88,15 @@ public:
      * Position and frame recorder.
      * @param position_source_addresses Addresses specifying position SOURCES to record
      * @param frame_source_addresses Addresses specifying frame SOURCES to record
+     * @param raw_frames Write frames to uncompressed raw frame files instead
+     * of compressed video
+     * @param position_list_source_addresses Addresses specifying position
+     * list SOURCES to record
      */
     Recorder(const std::vector<std::string> &position_source_addresses,
-             const std::vector<std::string> &frame_source_addresses);
+             const std::vector<std::string> &frame_source_addresses,
+             const bool raw_frames = false,
+             const std::vector<std::string> &position_list_source_addresses = {});
 
     ~Recorder();
 
@@ -141,6 +158,11 @@ private:
     std::vector< std::unique_ptr
                < cv::VideoWriter > > video_writers_;
 
+    // Raw frame files
+    bool raw_frames_ {false};
+    std::vector< std::unique_ptr
+               < oat::RawFrameWriter > > raw_writers_;
+
     // Position file
     FILE * position_fp_ {nullptr};
     char position_write_buffer[POSITION_WRITE_BUFFER_SIZE];
@@ -166,6 +188,10 @@ private:
     std::vector<uint64_t> position_write_number_;
     std::vector<PositionSource> position_sources_;
 
+    // Position list sources
+    std::vector<oat::PositionList2D> position_lists_;
+    std::vector<PositionListSource> position_list_sources_;
+
     // SOURCES EOF flag
     bool sources_eof {false};
 
@@ -177,7 +203,8 @@ private:
     void writePositionsToFile(void);
     void writePositionFileHeader(const std::string& date,
                                  const double sample_rate,
-                                 const std::vector<std::string>& sources);
+                                 const std::vector<std::string>& sources,
+                                 const std::vector<std::string>& list_sources);
 };
 
 }      /* namespace oat */
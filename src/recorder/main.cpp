@@ -49,6 +49,7 @@ std::string save_path;
 bool allow_overwrite = false;
 bool prepend_timestamp = false;
 bool prepend_source = false;
+bool raw_frames = false;
 
 // ZMQ stream
 using zmq_istream_t = boost::iostreams::stream<oat::zmq_istream>;
@@ -119,6 +120,7 @@ int main(int argc, char *argv[]) {
 
     std::vector<std::string> frame_sources;
     std::vector<std::string> position_sources;
+    std::vector<std::string> position_list_sources;
     std::string rpc_endpoint;
 
     try {
@@ -149,11 +151,18 @@ int main(int argc, char *argv[]) {
                 ("position-sources,p", po::value< std::vector<std::string> >()->multitoken(),
                 "The names of the POSITION SOURCES that supply object positions "
                 "to be recorded.")
+                ("position-list-sources,l", po::value< std::vector<std::string> >()->multitoken(),
+                "The names of the POSITION SOURCES that supply position lists, "
+                "e.g. a detector's blob_sink, to be recorded.")
                 ("interactive", "Start recorder with interactive controls enabled.")
                 ("rpc-endpoint", po::value<std::string>(&rpc_endpoint),
                  "Yield interactive control of the recorder to a remote source.")
                 ("frame-sources,s", po::value< std::vector<std::string> >()->multitoken(),
                 "The names of the FRAME SOURCES that supply images to save to video.")
+                ("raw",
+                "If specified, frames are saved uncompressed, with their sample "
+                "information, to raw frame files that can be served using "
+                "'oat frameserve raw' instead of to compressed video.")
                 ;
 
         po::options_description all_options("OPTIONS");
@@ -183,7 +192,9 @@ int main(int argc, char *argv[]) {
             return 0;
         }
 
-        if (!variable_map.count("position-sources") && !variable_map.count("frame-sources")) {
+        if (!variable_map.count("position-sources")
+            && !variable_map.count("position-list-sources")
+            && !variable_map.count("frame-sources")) {
             printUsage(std::cout, all_options);
             std::cerr << oat::Error("At least a single POSITION SOURCE or FRAME SOURCE must be specified.\n");
             return -1;
@@ -223,6 +234,18 @@ int main(int argc, char *argv[]) {
             }
         }
 
+        if (variable_map.count("position-list-sources")) {
+            position_list_sources = variable_map["position-list-sources"].as< std::vector<std::string> >();
+
+            // Assert that all position list sources are unique. If not, remove duplicates, and issue warning.
+            std::vector<std::string>::iterator it;
+            it = std::unique (position_list_sources.begin(), position_list_sources.end());
+            if (it != position_list_sources.end()) {
+                position_list_sources.resize(std::distance(position_list_sources.begin(),it));
+                std::cerr << oat::Warn("Warning: duplicate position list sources have been removed.\n");
+            }
+        }
+
         if (variable_map.count("frame-sources")) {
             frame_sources = variable_map["frame-sources"].as< std::vector<std::string> >();
 
@@ -244,6 +267,9 @@ int main(int argc, char *argv[]) {
         if (variable_map.count("allow-overwrite"))
             allow_overwrite = true;
 
+        if (variable_map.count("raw"))
+            raw_frames = true;
+
 
     } catch (std::exception& e) {
         std::cerr << oat::Error(e.what()) << "\n";
@@ -254,7 +280,10 @@ int main(int argc, char *argv[]) {
     }
 
     // Create component
-    auto recorder = std::make_shared<oat::Recorder>(position_sources, frame_sources);
+    auto recorder = std::make_shared<oat::Recorder>(position_sources,
+                                                    frame_sources,
+                                                    raw_frames,
+                                                    position_list_sources);
 
     // Tell user
     if (!frame_sources.empty()) {
@@ -279,6 +308,17 @@ int main(int argc, char *argv[]) {
         std::cout << ".\n";
     }
 
+    if (!position_list_sources.empty()) {
+
+        std::cout << oat::whoMessage(recorder->name(),
+                "Listening to position list sources ");
+
+        for (auto s : position_list_sources)
+            std::cout << oat::sourceText(s) << " ";
+
+        std::cout << ".\n";
+    }
+
     std::cout << oat::whoMessage(recorder->name(),
                  "Press CTRL+C to exit.\n");
 
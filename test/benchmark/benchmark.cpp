@@ -0,0 +1,236 @@
+//******************************************************************************
+//* File:   benchmark.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#include "OatConfig.h" // Generated by CMake
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "../../src/framefilter/BackgroundSubtractor.h"
+#include "../../src/framefilter/BackgroundSubtractorMOG.h"
+#include "../../src/positiondetector/HSVDetector.h"
+#include "../../lib/datatypes/Position2D.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Scratch configuration file used to configure each component
+const char * const CONFIG_FILE = "oat_benchmark.toml";
+
+// Every benchmark runs at each of these frame sizes
+const std::vector<cv::Size> FRAME_SIZES {cv::Size(640, 480),
+                                         cv::Size(1920, 1080),
+                                         cv::Size(3840, 2160)};
+
+/**
+ * Gives access to the filtering routine of a frame filter, which is
+ * otherwise only called on frames read from shared memory.
+ */
+template <typename Filter>
+class FilterBench : public Filter {
+public:
+
+    FilterBench() : Filter("benchmark_source", "benchmark_sink") { }
+
+    void run(cv::Mat &frame) { this->applyFilter(*this, frame); }
+};
+
+/**
+ * Gives access to the detection routine of a position detector, which is
+ * otherwise only called on frames read from shared memory.
+ */
+template <typename Detector>
+class DetectorBench : public Detector {
+public:
+
+    DetectorBench() : Detector("benchmark_source", "benchmark_sink") { }
+
+    void run(cv::Mat &frame, oat::Position2D &position) {
+        this->search_window_ = cv::Rect(cv::Point(0, 0), frame.size());
+        this->detectPosition(frame, position);
+    }
+};
+
+void writeConfig(const std::string &table) {
+
+    std::ofstream config(CONFIG_FILE);
+    config << "[benchmark]\n" << table << "\n";
+}
+
+// Frame i of n: an orange disk crossing a noisy, slowly brightening
+// background
+void drawFrame(const cv::Mat &background, const int i, const int n,
+               cv::RNG &rng, cv::Mat &frame) {
+
+    cv::add(background, cv::Scalar::all(i % 16), frame);
+
+    cv::Mat noise(frame.size(), frame.type());
+    rng.fill(noise, cv::RNG::UNIFORM, 0, 8);
+    frame += noise;
+
+    const int radius = frame.rows / 20;
+    const cv::Point center(radius + (frame.cols - 2 * radius) * i / n,
+                           frame.rows / 2);
+    cv::circle(frame, center, radius, cv::Scalar(30, 120, 240), -1);
+}
+
+/**
+ * Mean time to process a frame. Frames are drawn outside of the timed
+ * region, so only the processing routine is timed.
+ * @param size Frame size
+ * @param num_frames Number of frames to process
+ * @param process Processing routine, called with each frame
+ * @return Mean time per frame (ms)
+ */
+template <typename Process>
+double timeFrames(const cv::Size &size, const int num_frames, Process process) {
+
+    cv::RNG rng(1);
+    cv::Mat background(size, CV_8UC3), frame;
+    rng.fill(background, cv::RNG::UNIFORM, 0, 64);
+
+    Clock::duration total {0};
+    for (int i = 0; i < num_frames; i++) {
+
+        drawFrame(background, i, num_frames, rng, frame);
+
+        const auto start = Clock::now();
+        process(frame);
+        total += Clock::now() - start;
+    }
+
+    return std::chrono::duration<double, std::milli>(total).count() / num_frames;
+}
+
+void printTime(const std::string &name, const cv::Size &size, const double ms) {
+
+    std::cout << std::left << std::setw(32) << name
+              << std::right << std::setw(5) << size.width << "x"
+              << std::left << std::setw(6) << size.height
+              << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << ms << " ms/frame\n";
+}
+
+template <typename Filter>
+void timeFilter(const std::string &name, const std::string &config,
+                const int num_frames) {
+
+    for (auto &size : FRAME_SIZES) {
+
+        // Each size starts from a fresh model
+        writeConfig(config);
+        FilterBench<Filter> filter;
+        filter.configure(CONFIG_FILE, "benchmark");
+
+        printTime(name, size, timeFrames(size, num_frames,
+                  [&filter](cv::Mat &frame) { filter.run(frame); }));
+    }
+}
+
+template <typename Detector>
+void timeDetector(const std::string &name, const std::string &config,
+                  const int num_frames) {
+
+    for (auto &size : FRAME_SIZES) {
+
+        writeConfig(config);
+        DetectorBench<Detector> detector;
+        detector.configure(CONFIG_FILE, "benchmark");
+
+        // One untimed frame so that one-off setup (e.g. building lookup
+        // tables) is not counted
+        oat::Position2D position("benchmark");
+        cv::Mat warmup = cv::Mat::zeros(size, CV_8UC3);
+        detector.run(warmup, position);
+
+        printTime(name, size, timeFrames(size, num_frames,
+                  [&detector, &position](cv::Mat &frame) {
+                      detector.run(frame, position);
+                  }));
+    }
+}
+
+// Background models of bsub against the MOG2 model of mog, with the
+// same learning rate
+void benchmarkBackgroundSubtraction(const int num_frames) {
+
+    timeFilter<oat::BackgroundSubtractor>(
+        "bsub static", "adaptation = \"static\"", num_frames);
+    timeFilter<oat::BackgroundSubtractor>(
+        "bsub average", "adaptation = \"average\"\n"
+        "learning_coeff = 0.05", num_frames);
+    timeFilter<oat::BackgroundSubtractor>(
+        "bsub median", "adaptation = \"median\"", num_frames);
+    timeFilter<oat::BackgroundSubtractorMOG>(
+        "mog", "learning_coeff = 0.05", num_frames);
+    timeFilter<oat::BackgroundSubtractorMOG>(
+        "mog scale=0.5 update_interval=4", "learning_coeff = 0.05\n"
+        "scale = 0.5\n"
+        "update_interval = 4", num_frames);
+}
+
+// Fused color lookup table thresholding of the HSV detector against
+// conversion to HSV followed by inRange, for a target matching the disk
+void benchmarkHSVThreshold(const int num_frames) {
+
+    const std::string target = "erode = 0\n"
+                               "dilate = 0\n"
+                               "h_thresholds = {min = 5, max = 20}\n"
+                               "s_thresholds = {min = 100, max = 256}\n"
+                               "v_thresholds = {min = 150, max = 256}\n";
+
+    timeDetector<oat::HSVDetector>(
+        "hsv color_lut", target + "color_lut = true", num_frames);
+    timeDetector<oat::HSVDetector>(
+        "hsv cvtColor+inRange", target + "color_lut = false", num_frames);
+}
+
+} /* namespace */
+
+int main(int argc, char *argv[]) {
+
+    const int num_frames = argc > 1 ? std::atoi(argv[1]) : 50;
+    if (num_frames < 1) {
+        std::cerr << "Usage: oat-benchmark [NUM_FRAMES]\n";
+        return -1;
+    }
+
+    try {
+
+        benchmarkBackgroundSubtraction(num_frames);
+        benchmarkHSVThreshold(num_frames);
+
+    } catch (const std::exception &ex) {
+        std::cerr << ex.what() << "\n";
+        std::remove(CONFIG_FILE);
+        return -1;
+    }
+
+    std::remove(CONFIG_FILE);
+    return 0;
+}
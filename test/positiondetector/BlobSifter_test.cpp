@@ -0,0 +1,235 @@
+//******************************************************************************
+//* File:   BlobSifter_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "../../lib/datatypes/Position2D.h"
+#include "../../lib/datatypes/PositionList2D.h"
+#include "../../src/positiondetector/DetectorFunc.h"
+
+const double no_max = std::numeric_limits<double>::max();
+
+// Blobs found from the external contours of the mask, as the position
+// detectors did before BlobSifter
+struct Contour {
+    double area;
+    cv::Point2d centroid;
+};
+
+std::vector<Contour> externalContours(const cv::Mat &mask,
+                                      double min_area, double max_area) {
+
+    std::vector<std::vector<cv::Point> > contours;
+    cv::Mat m = mask.clone();
+    cv::findContours(m, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+
+    std::vector<Contour> blobs;
+    for (auto &c : contours) {
+
+        cv::Moments moment = cv::moments(cv::Mat(c));
+        const double area = moment.m00;
+
+        if (area > min_area && area < max_area)
+            blobs.push_back({area, cv::Point2d(moment.m10 / area,
+                                               moment.m01 / area)});
+    }
+
+    return blobs;
+}
+
+// Check sift() against the largest external contour, and its blob list
+// against every external contour within the area range
+void requireSameBlobs(oat::BlobSifter &sifter, const cv::Mat &mask,
+                      double min_area = 0.0, double max_area = no_max) {
+
+    const std::vector<Contour> contours
+        = externalContours(mask, min_area, max_area);
+
+    // Among equal areas, the first contour found wins
+    const Contour *largest = nullptr;
+    for (auto &c : contours) {
+        if (largest == nullptr || c.area > largest->area)
+            largest = &c;
+    }
+
+    oat::Position2D position;
+    oat::PositionList2D blobs("blobs");
+    double area = -1.0;
+    sifter.sift(mask, position, area, min_area, max_area, &blobs);
+
+    if (largest == nullptr) {
+        REQUIRE(!position.position_valid);
+        REQUIRE(area == 0.0);
+    } else {
+        REQUIRE(position.position_valid);
+        REQUIRE(area == largest->area);
+        REQUIRE(position.position.x == Approx(largest->centroid.x));
+        REQUIRE(position.position.y == Approx(largest->centroid.y));
+    }
+
+    std::vector<Contour> sorted = contours;
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const Contour &a, const Contour &b) {
+                         return a.area > b.area;
+                     });
+
+    REQUIRE(blobs.size() == std::min(sorted.size(), oat::POSITION_LIST_CAPACITY));
+    for (size_t i = 0; i < blobs.size(); i++) {
+        REQUIRE(blobs.id(i) == i);
+        REQUIRE(blobs[i].position.x == Approx(sorted[i].centroid.x));
+        REQUIRE(blobs[i].position.y == Approx(sorted[i].centroid.y));
+    }
+}
+
+SCENARIO ("BlobSifter finds the blobs of the external contours.", "[BlobSifter]") {
+
+    oat::BlobSifter sifter;
+
+    GIVEN ("An empty mask") {
+
+        cv::Mat mask = cv::Mat::zeros(20, 30, CV_8UC1);
+
+        THEN ("No blob is found") {
+            requireSameBlobs(sifter, mask);
+        }
+    }
+
+    GIVEN ("A filled square with a hole") {
+
+        cv::Mat mask = cv::Mat::zeros(40, 40, CV_8UC1);
+        cv::rectangle(mask, cv::Rect(5, 5, 30, 30), 255, -1);
+        cv::rectangle(mask, cv::Rect(12, 12, 10, 10), 0, -1);
+
+        THEN ("The hole is part of the blob's area") {
+            requireSameBlobs(sifter, mask);
+        }
+
+        WHEN ("A blob lies in the hole") {
+
+            cv::rectangle(mask, cv::Rect(15, 15, 4, 4), 255, -1);
+
+            THEN ("Only the enclosing blob is found") {
+                requireSameBlobs(sifter, mask);
+            }
+
+            THEN ("The inner blob is not found when the enclosing blob is too large") {
+                requireSameBlobs(sifter, mask, 0.0, 100.0);
+            }
+        }
+    }
+
+    GIVEN ("Blobs touching the frame border") {
+
+        cv::Mat mask = cv::Mat::zeros(30, 40, CV_8UC1);
+        cv::rectangle(mask, cv::Rect(0, 0, 6, 4), 255, -1);
+        cv::rectangle(mask, cv::Rect(30, 10, 10, 8), 255, -1);
+        cv::rectangle(mask, cv::Rect(10, 25, 7, 5), 255, -1);
+        cv::circle(mask, cv::Point(20, 12), 5, 255, 1);
+
+        THEN ("Each is found") {
+            requireSameBlobs(sifter, mask);
+        }
+
+        WHEN ("The whole frame is foreground") {
+
+            mask.setTo(255);
+
+            THEN ("A single blob is found") {
+                requireSameBlobs(sifter, mask);
+            }
+        }
+    }
+
+    GIVEN ("Blobs that touch only diagonally") {
+
+        cv::Mat mask = cv::Mat::zeros(30, 30, CV_8UC1);
+        cv::rectangle(mask, cv::Rect(4, 4, 5, 5), 255, -1);
+        cv::rectangle(mask, cv::Rect(9, 9, 6, 3), 255, -1);
+        cv::rectangle(mask, cv::Rect(15, 6, 3, 3), 255, -1);
+
+        // A diamond of diagonal lines, whose inside is a hole
+        cv::line(mask, cv::Point(20, 20), cv::Point(24, 16), 255);
+        cv::line(mask, cv::Point(24, 16), cv::Point(28, 20), 255);
+        cv::line(mask, cv::Point(28, 20), cv::Point(24, 24), 255);
+        cv::line(mask, cv::Point(24, 24), cv::Point(20, 20), 255);
+
+        THEN ("Diagonal neighbors belong to the same blob") {
+            requireSameBlobs(sifter, mask);
+        }
+    }
+
+    GIVEN ("Blobs of equal area") {
+
+        cv::Mat mask = cv::Mat::zeros(40, 40, CV_8UC1);
+        cv::rectangle(mask, cv::Rect(3, 3, 6, 6), 255, -1);
+        cv::rectangle(mask, cv::Rect(25, 8, 6, 6), 255, -1);
+        cv::rectangle(mask, cv::Rect(10, 28, 6, 6), 255, -1);
+
+        THEN ("Ties are broken the same way") {
+            requireSameBlobs(sifter, mask);
+        }
+    }
+
+    GIVEN ("Random masks") {
+
+        cv::RNG rng(42);
+
+        // The same sifter is reused across frames of different sizes
+        for (int i = 0; i < 500; i++) {
+
+            cv::Mat mask(rng.uniform(1, 80), rng.uniform(1, 80), CV_8UC1);
+
+            if (i % 2 == 0) {
+
+                // Noise of random density
+                cv::Mat noise(mask.size(), CV_32FC1);
+                rng.fill(noise, cv::RNG::UNIFORM, 0.0, 1.0);
+                mask = (noise < rng.uniform(0.0, 1.0));
+
+            } else {
+
+                // Shapes, rings and holes
+                mask.setTo(0);
+                for (int k = rng.uniform(1, 7); k > 0; k--) {
+                    const cv::Point p(rng.uniform(0, mask.cols + 1),
+                                      rng.uniform(0, mask.rows + 1));
+                    const int r = rng.uniform(1, 12);
+                    if (k % 2)
+                        cv::circle(mask, p, r, 255, rng.uniform(0, 3) == 0 ? -1 : 1);
+                    else
+                        cv::rectangle(mask, cv::Rect(p, cv::Size(r, r)),
+                                      rng.uniform(0, 3) == 0 ? 0 : 255, -1);
+                }
+            }
+
+            const double min_area = rng.uniform(0, 3) == 0 ? 3.5 : 0.0;
+            const double max_area = rng.uniform(0, 3) == 0 ? 50.0 : no_max;
+
+            INFO ("Mask " << i << ": " << mask.rows << "x" << mask.cols);
+            requireSameBlobs(sifter, mask, min_area, max_area);
+        }
+    }
+}
@@ -0,0 +1,126 @@
+//******************************************************************************
+//* File:   DifferenceThreshold_test.cpp
+//* Author: Jon Newman <jpnewman snail mit dot edu>
+//*
+//* Copyright (c) Jon Newman (jpnewman snail mit dot edu)
+//* All right reserved.
+//* This file is part of the Oat project.
+//* This is free software: you can redistribute it and/or modify
+//* it under the terms of the GNU General Public License as published by
+//* the Free Software Foundation, either version 3 of the License, or
+//* (at your option) any later version.
+//* This software is distributed in the hope that it will be useful,
+//* but WITHOUT ANY WARRANTY; without even the implied warranty of
+//* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//* GNU General Public License for more details.
+//* You should have received a copy of the GNU General Public License
+//* along with this source code.  If not, see <http://www.gnu.org/licenses/>.
+//******************************************************************************
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "../../src/positiondetector/DetectorFunc.h"
+
+// Motion threshold as the difference detector computed it before the
+// thresholds were fused
+cv::Mat referenceThreshold(const cv::Mat &current, const cv::Mat &last,
+                           int threshold, const cv::Size &ksize) {
+
+    cv::Mat t;
+    cv::absdiff(current, last, t);
+    cv::threshold(t, t, threshold, 255, cv::THRESH_BINARY);
+
+    if (ksize.area() > 0) {
+        cv::blur(t, t, ksize);
+        cv::threshold(t, t, threshold, 255, cv::THRESH_BINARY);
+    }
+
+    return t;
+}
+
+cv::Mat fusedThreshold(const cv::Mat &current, const cv::Mat &last,
+                       int threshold, const cv::Size &ksize) {
+
+    cv::Mat t(current.size(), CV_8UC1);
+
+    if (ksize.area() > 0) {
+        cv::Mat motion(current.size(), CV_8UC1);
+        std::vector<int> column_sums;
+        oat::differenceThreshold(current, last, threshold, 1, motion);
+        oat::boxThreshold(motion, ksize, oat::minBoxCount(ksize, threshold),
+                          column_sums, t);
+    } else {
+        oat::differenceThreshold(current, last, threshold, 255, t);
+    }
+
+    return t;
+}
+
+void requireSameThreshold(const cv::Mat &current, const cv::Mat &last,
+                          int threshold, const cv::Size &ksize) {
+
+    INFO ("Frame " << current.rows << "x" << current.cols
+          << ", threshold " << threshold << ", blur " << ksize.width);
+
+    const cv::Mat ref = referenceThreshold(current, last, threshold, ksize);
+    const cv::Mat fused = fusedThreshold(current, last, threshold, ksize);
+    REQUIRE(cv::countNonZero(ref != fused) == 0);
+}
+
+SCENARIO ("Fused motion thresholds match absdiff, threshold and blur.", "[DifferenceDetector]") {
+
+    GIVEN ("6 moved pixels within a 6x6 blur box and a threshold of 42") {
+
+        // The blurred value, 255 * 6 / 36 = 42.5, lies on a rounding edge
+        cv::Mat last = cv::Mat::zeros(20, 20, CV_8UC1);
+        cv::Mat current = last.clone();
+        current(cv::Rect(7, 8, 3, 2)).setTo(200);
+
+        THEN ("Pixels pass as they do after cv::blur") {
+            requireSameThreshold(current, last, 42, cv::Size(6, 6));
+        }
+    }
+
+    GIVEN ("Random frames") {
+
+        cv::RNG rng(7);
+        const std::vector<int> blur_sizes {0, 1, 2, 3, 5, 6, 16, 17, 25, 50};
+
+        for (int i = 0; i < 300; i++) {
+
+            // Small frames are reflected several times by large kernels
+            const int rows = rng.uniform(1, i % 3 == 0 ? 12 : 100);
+            const int cols = rng.uniform(1, i % 3 == 0 ? 12 : 100);
+
+            cv::Mat current(rows, cols, CV_8UC1), last(rows, cols, CV_8UC1);
+            rng.fill(current, cv::RNG::UNIFORM, 0, 256);
+            rng.fill(last, cv::RNG::UNIFORM, 0, 256);
+
+            const int threshold = rng.uniform(0, 257);
+            const int k = blur_sizes[rng.uniform(
+                0, static_cast<int>(blur_sizes.size()))];
+
+            requireSameThreshold(current, last, threshold, cv::Size(k, k));
+        }
+    }
+
+    GIVEN ("Every threshold") {
+
+        cv::RNG rng(11);
+        cv::Mat current(40, 50, CV_8UC1), last(40, 50, CV_8UC1);
+        rng.fill(current, cv::RNG::UNIFORM, 0, 256);
+        rng.fill(last, cv::RNG::UNIFORM, 0, 256);
+
+        THEN ("Small and large kernels match") {
+            for (int threshold = 0; threshold <= 256; threshold++) {
+                requireSameThreshold(current, last, threshold, cv::Size(4, 4));
+                requireSameThreshold(current, last, threshold, cv::Size(20, 20));
+            }
+        }
+    }
+}
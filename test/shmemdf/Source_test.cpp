@@ -21,10 +21,13 @@
 #include <catch.hpp>
 
 #include <string>
+#include <opencv2/core.hpp>
 
 #include "../../lib/shmemdf/Source.h"
 #include "../../lib/shmemdf/Sink.h"
 #include "../../lib/shmemdf/SharedFrameHeader.h"
+#include "../../lib/datatypes/PositionList2D.h"
+#include "../../lib/utility/PackedMask.h"
 
 const std::string node_addr = "test";
 
@@ -211,5 +214,166 @@ SCENARIO ("Connected sources can retrieve shared objects to mutate them.", "[Sou
     }
 }
 
+SCENARIO ("Frame sources receive the frame geometry set by the sink.", "[Source, SharedFrameHeader]") {
+
+    GIVEN ("A bound Sink<SharedFrameHeader> that retrieves a cropped frame") {
+
+        oat::Sink<oat::SharedFrameHeader> sink;
+        oat::Source<oat::SharedFrameHeader> source;
+        size_t rows {20};
+        size_t cols {30};
+        int type {CV_8UC3};
+
+        INFO ("The sink binds a node and retrieves a frame with an offset");
+        sink.bind(node_addr, rows * cols * 3);
+        oat::Frame frame = sink.retrieve(rows, cols, type, 5, 7);
+
+        WHEN ("The source connects to the node") {
+
+            source.touch(node_addr);
+            source.connect();
+
+            THEN ("The source's connection parameters match the sink's frame") {
+
+                auto param = source.parameters();
+                REQUIRE( param.rows == rows );
+                REQUIRE( param.cols == cols );
+                REQUIRE( param.type == static_cast<size_t>(type) );
+                REQUIRE( param.bytes == rows * cols * 3 );
+                REQUIRE( param.offset_x == 5 );
+                REQUIRE( param.offset_y == 7 );
+                REQUIRE( param.scale_x == 1.0 );
+                REQUIRE( param.scale_y == 1.0 );
+            }
+        }
+    }
+
+    GIVEN ("A bound Sink<SharedFrameHeader> that retrieves a resized frame") {
+
+        oat::Sink<oat::SharedFrameHeader> sink;
+        oat::Source<oat::SharedFrameHeader> source;
+        size_t rows {20};
+        size_t cols {30};
+
+        INFO ("The sink binds a node and retrieves a frame with a scale");
+        sink.bind(node_addr, rows * cols);
+        oat::Frame frame = sink.retrieve(rows, cols, CV_8UC1, 1.5, 0.5, false, 4.0, 2.0);
+
+        WHEN ("The source connects to the node") {
+
+            source.touch(node_addr);
+            source.connect();
+
+            THEN ("The source's mapping to the full frame matches the sink's") {
+
+                auto param = source.parameters();
+                REQUIRE( param.offset_x == 1.5 );
+                REQUIRE( param.offset_y == 0.5 );
+                REQUIRE( param.scale_x == 4.0 );
+                REQUIRE( param.scale_y == 2.0 );
+            }
+        }
+    }
+}
+
+SCENARIO ("Frame sources unpack packed binary masks.", "[Source, SharedFrameHeader]") {
+
+    GIVEN ("A bound Sink<SharedFrameHeader> that publishes a packed mask") {
+
+        oat::Sink<oat::SharedFrameHeader> sink;
+        oat::Source<oat::SharedFrameHeader> source;
+        int rows {4};
+        int cols {21};
+
+        cv::Mat mask(rows, cols, CV_8UC1);
+        for (int r = 0; r < rows; r++)
+            for (int c = 0; c < cols; c++)
+                mask.at<uint8_t>(r, c) = (r + c) % 3 == 0 ? 0 : r + c;
+
+        INFO ("The sink binds a node and packs a mask into it");
+        sink.bind(node_addr, rows * oat::packedCols(cols));
+        oat::Frame frame = sink.retrieve(rows, cols, CV_8UC1, 0, 0, true);
+        REQUIRE( frame.cols == oat::packedCols(cols) );
+        oat::packMask(mask, frame);
+
+        WHEN ("The source connects to the node and copies the frame") {
+
+            source.touch(node_addr);
+            source.connect();
+
+            oat::Frame unpacked;
+            source.copyTo(unpacked);
+
+            THEN ("The source's connection parameters describe the unpacked mask") {
+
+                auto param = source.parameters();
+                REQUIRE( param.packed );
+                REQUIRE( param.rows == static_cast<size_t>(rows) );
+                REQUIRE( param.cols == static_cast<size_t>(cols) );
+                REQUIRE( param.type == static_cast<size_t>(CV_8UC1) );
+                REQUIRE( param.bytes == static_cast<size_t>(rows * cols) );
+            }
+
+            THEN ("The copy is 255 at non-zero pixels of the mask and 0 elsewhere") {
+
+                REQUIRE( unpacked.rows == rows );
+                REQUIRE( unpacked.cols == cols );
+                REQUIRE( cv::countNonZero(unpacked != (mask != 0)) == 0 );
+            }
+        }
+    }
+}
+
+SCENARIO ("Position list sources receive every position published by the sink.", "[Source, PositionList2D]") {
+
+    GIVEN ("A bound Sink<PositionList2D> and a connected Source<PositionList2D>") {
+
+        oat::Sink<oat::PositionList2D> sink;
+        oat::Source<oat::PositionList2D> source;
+
+        INFO ("The sink binds a node");
+        sink.bind(node_addr, node_addr);
+        source.touch(node_addr);
+        source.connect();
+
+        WHEN ("The sink publishes a list of three positions") {
+
+            oat::PositionList2D list("internal");
+            for (uint32_t i = 0; i < 3; i++) {
+                oat::Position2D p;
+                p.position_valid = true;
+                p.position = oat::Point2D(i, 2 * i);
+                REQUIRE( list.push_back(p, 10 + i) );
+            }
+
+            *sink.retrieve() = list;
+
+            THEN ("The source's copy holds the same positions and ids") {
+
+                oat::PositionList2D copy = source.clone();
+                REQUIRE( copy.size() == 3 );
+                REQUIRE( std::string(copy.label()) == node_addr );
+                for (uint32_t i = 0; i < 3; i++) {
+                    REQUIRE( copy.id(i) == 10 + i );
+                    REQUIRE( copy[i].position_valid );
+                    REQUIRE( copy[i].position == oat::Point2D(i, 2 * i) );
+                }
+            }
+        }
+
+        WHEN ("The list is filled to capacity") {
+
+            oat::PositionList2D &list = *sink.retrieve();
+            for (size_t i = 0; i < oat::POSITION_LIST_CAPACITY; i++)
+                REQUIRE( list.push_back(oat::Position2D(), i) );
+
+            THEN ("Further positions are rejected") {
+                REQUIRE( list.full() );
+                REQUIRE_FALSE( list.push_back(oat::Position2D(), 0) );
+                REQUIRE( source.retrieve()->size() == oat::POSITION_LIST_CAPACITY );
+            }
+        }
+    }
+}
 
 // TODO: specialization tests